@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Counts heap allocations made through the global operator new, so a
+// benchmark can show that a code path does not allocate. Reading the count
+// works from any file; the replacement operators themselves are only
+// compiled where ALLOCATION_COUNTER_IMPLEMENTATION is defined before the
+// include, which must happen in exactly one .cpp file of the program.
+inline std::atomic<long long>& heapAllocationCounter() {
+    static std::atomic<long long> count(0);
+    return count;
+}
+
+inline long long heapAllocations() {
+    return heapAllocationCounter().load(std::memory_order_relaxed);
+}
+
+#ifdef ALLOCATION_COUNTER_IMPLEMENTATION
+// Every operator delete here frees memory that the operator new here got
+// from malloc, but once they are inlined GCC only sees free() called on a
+// pointer from operator new and warns that the two do not match
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    heapAllocationCounter().fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+#ifdef __cpp_aligned_new
+// Over-aligned types under C++17. malloc only guarantees alignment for
+// ordinary types, so the block is over-allocated, the returned pointer
+// rounded up, and the pointer malloc gave stored just before it for delete.
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    heapAllocationCounter().fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* block = std::malloc(size + align + sizeof(void*))) {
+        std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(block) + sizeof(void*) + align - 1) & ~(align - 1);
+        std::memcpy(reinterpret_cast<void*>(aligned - sizeof(void*)), &block, sizeof(void*));
+        return reinterpret_cast<void*>(aligned);
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    if (!memory) return;
+    void* block;
+    std::memcpy(&block, reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(memory) - sizeof(void*)), sizeof(void*));
+    std::free(block);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+#endif
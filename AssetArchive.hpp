@@ -0,0 +1,289 @@
+#pragma once
+
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Every asset in one file, so startup opens and maps a single file instead
+// of looking up each one by name. The layout (little-endian) is a header,
+// a table of contents with one fixed-size entry per asset, then the asset
+// bytes, each starting on an alignment boundary:
+//
+//     Header | Entry x count | pad | asset 0 | pad | asset 1 | ...
+//
+// Assets are stored as the file bytes, or for images optionally already
+// decoded to RGBA so loading them skips PNG/JPG decoding. The archive is
+// memory-mapped, and find() hands out pointers straight into the mapping
+// for loadFromMemory/openFromMemory; fonts and music read from that memory
+// as they are used, so the archive must stay open while they are.
+namespace AssetArchiveFormat {
+    const char magic[4] = { 'H', 'T', 'Z', 'P' };
+    const std::uint32_t version = 1;
+    const std::uint32_t alignment = 64;
+    const int nameLength = 64; // including the terminating zero
+
+    enum Kind : std::uint32_t {
+        FILE_BYTES,  // the asset's file as it was on disk
+        IMAGE_RGBA   // width * height * 4 bytes of decoded pixels
+    };
+
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t alignment;
+    };
+
+    struct Entry {
+        char name[nameLength];
+        std::uint64_t offset; // from the start of the archive
+        std::uint64_t size;
+        std::uint32_t kind;
+        std::uint32_t width;  // images stored as IMAGE_RGBA only
+        std::uint32_t height;
+        std::uint32_t reserved;
+    };
+
+    inline std::uint64_t alignUp(std::uint64_t offset) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+// Read-only view of a packed archive
+class AssetArchive {
+public:
+    // One asset in the mapped archive; data is null if there is no such asset
+    struct Asset {
+        const void* data = nullptr;
+        std::size_t size = 0;
+        bool rgba = false;
+        unsigned width = 0;
+        unsigned height = 0;
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    AssetArchive() = default;
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    ~AssetArchive() {
+        close();
+    }
+
+    // Maps the archive and checks its table of contents. Returns false,
+    // leaving the archive empty, if the file is missing or malformed.
+    bool open(const std::string& filename) {
+        close();
+        if (!map(filename)) return false;
+
+        using namespace AssetArchiveFormat;
+        Header header;
+        if (size < sizeof(Header)) return fail();
+        std::memcpy(&header, bytes, sizeof(Header));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version) return fail();
+        if (size < sizeof(Header) + static_cast<std::uint64_t>(header.entryCount) * sizeof(Entry)) return fail();
+
+        entries.resize(header.entryCount);
+        std::memcpy(entries.data(), bytes + sizeof(Header), entries.size() * sizeof(Entry));
+        for (Entry& entry : entries) {
+            entry.name[nameLength - 1] = '\0';
+            if (entry.offset > size || entry.size > size - entry.offset) return fail();
+            if (entry.kind == IMAGE_RGBA && entry.size != static_cast<std::uint64_t>(entry.width) * entry.height * 4) return fail();
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return std::strcmp(a.name, b.name) < 0;
+        });
+        return true;
+    }
+
+    void close() {
+        entries.clear();
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap(const_cast<unsigned char*>(bytes), size);
+#endif
+        bytes = nullptr;
+        size = 0;
+    }
+
+    bool isOpen() const {
+        return bytes != nullptr;
+    }
+
+    int assetCount() const {
+        return static_cast<int>(entries.size());
+    }
+
+    Asset find(const std::string& name) const {
+        Asset asset;
+        auto found = std::lower_bound(entries.begin(), entries.end(), name, [](const AssetArchiveFormat::Entry& entry, const std::string& key) {
+            return std::strcmp(entry.name, key.c_str()) < 0;
+        });
+        if (found == entries.end() || name != found->name) return asset;
+        asset.data = bytes + found->offset;
+        asset.size = static_cast<std::size_t>(found->size);
+        asset.rgba = found->kind == AssetArchiveFormat::IMAGE_RGBA;
+        asset.width = found->width;
+        asset.height = found->height;
+        return asset;
+    }
+
+    // Loads an archived image, decoding it only if it was not stored as RGBA.
+    // Returns false if it is not in the archive or does not decode.
+    bool loadImage(sf::Image& image, const std::string& name) const {
+        Asset asset = find(name);
+        if (!asset) return false;
+        if (asset.rgba) {
+            image.create(asset.width, asset.height, static_cast<const sf::Uint8*>(asset.data));
+            return true;
+        }
+        return image.loadFromMemory(asset.data, asset.size);
+    }
+
+private:
+    std::vector<AssetArchiveFormat::Entry> entries; // sorted by name
+    const unsigned char* bytes = nullptr;
+    std::uint64_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    bool fail() {
+        close();
+        return false;
+    }
+
+    bool map(const std::string& filename) {
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return fail();
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return fail();
+        bytes = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!bytes) return fail();
+        size = static_cast<std::uint64_t>(fileSize.QuadPart);
+        return true;
+#else
+        int descriptor = ::open(filename.c_str(), O_RDONLY);
+        if (descriptor < 0) return false;
+        struct stat info;
+        if (fstat(descriptor, &info) != 0 || info.st_size == 0) {
+            ::close(descriptor);
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor);
+        if (mapped == MAP_FAILED) return false;
+        bytes = static_cast<const unsigned char*>(mapped);
+        size = static_cast<std::uint64_t>(info.st_size);
+        return true;
+#endif
+    }
+};
+
+// Builds an archive from files on disk; used by --pack
+class AssetArchiveWriter {
+public:
+    // Adds a file under its own name. With decodeImage the file must be an
+    // image SFML can read, and its decoded RGBA pixels are stored instead.
+    bool addFile(const std::string& filename, bool decodeImage) {
+        using namespace AssetArchiveFormat;
+        if (filename.size() >= static_cast<size_t>(nameLength)) return false;
+
+        Pending pending;
+        pending.entry = Entry();
+        std::strncpy(pending.entry.name, filename.c_str(), nameLength - 1);
+        if (decodeImage) {
+            sf::Image image;
+            if (!image.loadFromFile(filename)) return false;
+            const sf::Uint8* pixels = image.getPixelsPtr();
+            pending.entry.kind = IMAGE_RGBA;
+            pending.entry.width = image.getSize().x;
+            pending.entry.height = image.getSize().y;
+            pending.bytes.assign(pixels, pixels + static_cast<size_t>(image.getSize().x) * image.getSize().y * 4);
+        }
+        else {
+            std::ifstream file(filename, std::ios::binary);
+            if (!file) return false;
+            pending.entry.kind = FILE_BYTES;
+            pending.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        pending.entry.size = pending.bytes.size();
+        assets.push_back(std::move(pending));
+        return true;
+    }
+
+    bool write(const std::string& filename) {
+        using namespace AssetArchiveFormat;
+        Header header;
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.entryCount = static_cast<std::uint32_t>(assets.size());
+        header.alignment = alignment;
+
+        std::uint64_t offset = alignUp(sizeof(Header) + assets.size() * sizeof(Entry));
+        for (Pending& pending : assets) {
+            pending.entry.offset = offset;
+            offset = alignUp(offset + pending.entry.size);
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        for (const Pending& pending : assets) {
+            file.write(reinterpret_cast<const char*>(&pending.entry), sizeof(Entry));
+        }
+        for (const Pending& pending : assets) {
+            pad(file, pending.entry.offset);
+            file.write(pending.bytes.data(), pending.bytes.size());
+        }
+        return static_cast<bool>(file);
+    }
+
+    int assetCount() const {
+        return static_cast<int>(assets.size());
+    }
+
+private:
+    struct Pending {
+        AssetArchiveFormat::Entry entry;
+        std::vector<char> bytes;
+    };
+
+    std::vector<Pending> assets;
+
+    static void pad(std::ofstream& file, std::uint64_t offset) {
+        static const char zeros[AssetArchiveFormat::alignment] = {};
+        std::uint64_t position = static_cast<std::uint64_t>(file.tellp());
+        file.write(zeros, static_cast<std::streamsize>(offset - position));
+    }
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Loads assets in two steps so startup never stalls the window:
+//
+//     loader.add([&] { image.loadFromFile("player.png"); },  // worker thread
+//                [&] { texture.loadFromImage(image); });      // main thread
+//     loader.start(4);
+//     while (!loader.done()) {
+//         loader.uploadReady(2);
+//         ... draw a progress bar with loader.progress() ...
+//     }
+//
+// decode runs on a worker and must only touch state of its own asset, such
+// as reading a file into an sf::Image. upload runs on the thread calling
+// uploadReady or finish, which is the one with the GL context, in the order
+// decodes complete. Assets must all be added before start().
+class AssetLoader {
+public:
+    ~AssetLoader() {
+        next.store(static_cast<int>(assets.size()));
+        for (auto& worker : workers) worker.join();
+    }
+
+    void add(std::function<void()> decode, std::function<void()> upload) {
+        assets.push_back(Asset{ std::move(decode), std::move(upload) });
+    }
+
+    // Starts decoding on threadCount workers; with 0, finish() decodes
+    // everything on the calling thread
+    void start(int threadCount) {
+        ready.reserve(assets.size());
+        threadCount = std::min(threadCount, static_cast<int>(assets.size()));
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back([this] { decodeAll(); });
+        }
+    }
+
+    // Runs at most maxUploads uploads of decoded assets; returns how many ran
+    int uploadReady(int maxUploads) {
+        int uploads = 0;
+        while (uploads < maxUploads) {
+            int index;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (uploaded == static_cast<int>(ready.size())) break;
+                index = ready[uploaded];
+            }
+            assets[index].upload();
+            uploaded++;
+            uploads++;
+        }
+        return uploads;
+    }
+
+    // Decodes whatever no worker has claimed yet on this thread, then
+    // waits for the rest and uploads everything
+    void finish() {
+        decodeAll();
+        std::unique_lock<std::mutex> lock(mutex);
+        decodedAll.wait(lock, [this] { return ready.size() == assets.size(); });
+        lock.unlock();
+        uploadReady(static_cast<int>(assets.size()));
+    }
+
+    // Fraction of decodes and uploads done, 0 to 1
+    float progress() const {
+        if (assets.empty()) return 1.0f;
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<float>(ready.size() + uploaded) / (2 * assets.size());
+    }
+
+    bool done() const {
+        return uploaded == static_cast<int>(assets.size());
+    }
+
+private:
+    struct Asset {
+        std::function<void()> decode;
+        std::function<void()> upload;
+    };
+
+    std::vector<Asset> assets;
+    std::vector<std::thread> workers;
+    std::atomic<int> next{ 0 }; // next asset to decode
+    mutable std::mutex mutex;
+    std::condition_variable decodedAll;
+    std::vector<int> ready;     // decoded assets, in the order they finished
+    int uploaded = 0;           // uploads done, from the front of ready
+
+    void decodeAll() {
+        for (int index = next++; index < static_cast<int>(assets.size()); index = next++) {
+            assets[index].decode();
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(index);
+            if (ready.size() == assets.size()) decodedAll.notify_all();
+        }
+    }
+};
@@ -0,0 +1,65 @@
+#include <SFML/Graphics.hpp>
+#define ALLOCATION_COUNTER_IMPLEMENTATION
+#include "AllocationCounter.hpp"
+#include "World.hpp"
+#include "Benchmarks.hpp"
+#include "Scenarios.hpp"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Benchmark program: runs the stress scenarios in Scenarios.hpp and prints
+// their results as JSON on stdout, so they can be collected by scripts and
+// compared between builds. Progress goes to stderr.
+//
+//     Benchmarks.exe [--json results.json] [scenario ...]
+//     Benchmarks.exe --list
+//     Benchmarks.exe --micro collision
+int main(int argc, char* argv[]) {
+    std::vector<const StressScenario*> selected;
+    std::string jsonFile;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            for (const StressScenario& scenario : stressScenarios()) {
+                std::cout << scenario.name << " - " << scenario.description << " (" << scenario.ticks << " ticks)\n";
+            }
+            return 0;
+        }
+        else if (arg == "--micro" && i + 1 < argc) {
+            return runBenchmark(argv[++i]);
+        }
+        else if (arg == "--json" && i + 1 < argc) {
+            jsonFile = argv[++i];
+        }
+        else if (const StressScenario* scenario = findStressScenario(arg)) {
+            selected.push_back(scenario);
+        }
+        else {
+            std::cerr << "Unknown scenario '" << arg << "'. Run with --list to see them." << std::endl;
+            return 1;
+        }
+    }
+    if (selected.empty()) {
+        for (const StressScenario& scenario : stressScenarios()) selected.push_back(&scenario);
+    }
+
+    GameArt art = loadHeadlessArt();
+    std::vector<ScenarioResult> results;
+    for (const StressScenario* scenario : selected) {
+        std::cerr << "Running " << scenario->name << " - " << scenario->description << "..." << std::endl;
+        results.push_back(runScenario(*scenario, art));
+    }
+
+    std::string json = scenarioResultsJson(results);
+    std::cout << json;
+    if (!jsonFile.empty()) {
+        std::ofstream file(jsonFile);
+        if (!(file << json)) {
+            std::cerr << "Could not write " << jsonFile << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
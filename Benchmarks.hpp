@@ -0,0 +1,1438 @@
+#pragma once
+
+#include "World.hpp"
+#include "AllocationCounter.hpp"
+#include "Hud.hpp"
+#include "TextureManager.hpp"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Micro-benchmarks for the simulation, run with --bench <name>. They only
+// need the headless art, so they work on machines without a display.
+
+// Random enemies spread over the arena, the way a large horde ends up
+inline EnemyStore makeBenchmarkHorde(const GameArt& art, int count, std::mt19937& rng, sf::Vector2f arenaSize = sf::Vector2f(1600, 900)) {
+    std::uniform_real_distribution<float> xDist(0, arenaSize.x);
+    std::uniform_real_distribution<float> yDist(0, arenaSize.y);
+    EnemyStore enemies;
+    enemies.setArt(art.enemy1, art.enemy2);
+    enemies.reserve(count);
+    for (int i = 0; i < count; i++) {
+        EnemyType type = (i % 5 < 3) ? ENEMY_TYPE_1 : ENEMY_TYPE_2;
+        float x = xDist(rng);
+        float y = yDist(rng);
+        enemies.spawn(x, y, type, rng);
+    }
+    return enemies;
+}
+
+// The bullet before BulletStore: an object owning its own CircleShape
+class LegacyBullet {
+public:
+    sf::CircleShape shape;
+    sf::Vector2f velocity;
+    bool active;
+    sf::Vector2f previousPosition; // position before the last update, for interpolation
+    sf::FloatRect bounds;          // kept in step with the shape by fire() and update()
+
+    LegacyBullet() {
+        shape.setRadius(4);
+        shape.setFillColor(sf::Color::Yellow);
+        active = false;
+    }
+
+    LegacyBullet(float x, float y, sf::Vector2f direction) : LegacyBullet() {
+        fire(x, y, direction);
+    }
+
+    // Launches the bullet from (x, y), reusing its shape
+    void fire(float x, float y, sf::Vector2f direction, float speed = 600.0f) {
+        shape.setPosition(x - 4, y - 4);
+        previousPosition = shape.getPosition();
+        velocity = direction * speed;
+        active = true;
+        updateBounds();
+    }
+
+    // Bullets die on the update after leaving the arena, which starts at
+    // (0, 0), so the move that carried them out is still checked for hits
+    void update(float deltaTime, sf::Vector2f arenaSize = sf::Vector2f(1600, 900)) {
+        if (active) {
+            sf::Vector2f pos = shape.getPosition();
+            if (pos.x < 0 || pos.x > arenaSize.x || pos.y < 0 || pos.y > arenaSize.y) {
+                active = false;
+                return;
+            }
+            previousPosition = pos;
+            shape.move(velocity * deltaTime);
+            updateBounds();
+        }
+    }
+
+    sf::FloatRect getBounds() const {
+        return bounds;
+    }
+
+    // Bounds covering the whole of the last move, for the broad-phase
+    sf::FloatRect getSweptBounds() const {
+        sf::Vector2f offset = previousPosition - shape.getPosition();
+        float left = std::min(bounds.left, bounds.left + offset.x);
+        float top = std::min(bounds.top, bounds.top + offset.y);
+        return sf::FloatRect(left, top, bounds.width + std::abs(offset.x), bounds.height + std::abs(offset.y));
+    }
+
+private:
+    // The same rect shape.getGlobalBounds() gives, without building the
+    // transform: the shape is only ever moved, never turned or scaled
+    void updateBounds() {
+        sf::Vector2f pos = shape.getPosition();
+        float diameter = shape.getRadius() * 2;
+        bounds = sf::FloatRect(pos.x, pos.y, (pos.x + diameter) - pos.x, (pos.y + diameter) - pos.y);
+    }
+};
+
+inline std::vector<LegacyBullet> makeBenchmarkBullets(int count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> xDist(0, 1600);
+    std::uniform_real_distribution<float> yDist(0, 900);
+    std::uniform_real_distribution<float> angleDist(0, 6.2831853f);
+    std::vector<LegacyBullet> bullets;
+    bullets.reserve(count);
+    for (int i = 0; i < count; i++) {
+        float angle = angleDist(rng);
+        float x = xDist(rng);
+        float y = yDist(rng);
+        bullets.push_back(LegacyBullet(x, y, sf::Vector2f(cos(angle), sin(angle))));
+    }
+    return bullets;
+}
+
+// The same bullets as makeBenchmarkBullets() draws, in a BulletStore
+inline BulletStore makeBenchmarkBulletStore(int count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> xDist(0, 1600);
+    std::uniform_real_distribution<float> yDist(0, 900);
+    std::uniform_real_distribution<float> angleDist(0, 6.2831853f);
+    BulletStore bullets(count);
+    for (int i = 0; i < count; i++) {
+        float angle = angleDist(rng);
+        float x = xDist(rng);
+        float y = yDist(rng);
+        bullets.spawn(x, y, sf::Vector2f(cos(angle), sin(angle)));
+    }
+    return bullets;
+}
+
+// Bullet-vs-enemy pass: every pair against the spatial hash broad-phase.
+// Entities do not move, so both methods must find the same hits.
+inline int runCollisionBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int bulletCount = 256;
+    const int enemyCounts[] = { 100, 1000, 10000, 50000 };
+
+    std::cout << "Bullet-vs-enemy collision, " << bulletCount << " bullets\n"
+        << std::setw(8) << "enemies"
+        << std::setw(16) << "brute pairs" << std::setw(14) << "brute ms"
+        << std::setw(16) << "grid pairs" << std::setw(14) << "grid ms"
+        << std::setw(10) << "speedup" << std::setw(8) << "hits" << "\n";
+
+    bool allMatch = true;
+    for (int enemyCount : enemyCounts) {
+        std::mt19937 rng(42);
+        EnemyStore enemies = makeBenchmarkHorde(art, enemyCount, rng);
+        std::vector<LegacyBullet> bullets = makeBenchmarkBullets(bulletCount, rng);
+        const int ticks = enemyCount >= 10000 ? 10 : 100;
+
+        long long brutePairs = 0;
+        int bruteHits = 0;
+        sf::Clock clock;
+        for (int tick = 0; tick < ticks; tick++) {
+            bruteHits = 0;
+            for (const auto& bullet : bullets) {
+                for (int i = 0; i < enemyCount; i++) {
+                    brutePairs++;
+                    if (checkCollision(bullet.getBounds(), enemies.getBounds(i))) {
+                        bruteHits++;
+                        break;
+                    }
+                }
+            }
+        }
+        double bruteMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+        SpatialHash grid;
+        long long gridPairs = 0;
+        int gridHits = 0;
+        clock.restart();
+        for (int tick = 0; tick < ticks; tick++) {
+            gridHits = 0;
+            grid.build(enemyCount, [&](int i) { return enemies.getBounds(i); });
+            for (const auto& bullet : bullets) {
+                sf::FloatRect bulletBounds = bullet.getBounds();
+                int hit = -1;
+                grid.query(bulletBounds, [&](int i) {
+                    gridPairs++;
+                    if ((hit < 0 || i < hit) && checkCollision(bulletBounds, enemies.getBounds(i))) {
+                        hit = i;
+                    }
+                });
+                if (hit >= 0) gridHits++;
+            }
+        }
+        double gridMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+        allMatch = allMatch && bruteHits == gridHits;
+        std::cout << std::setw(8) << enemyCount
+            << std::setw(16) << brutePairs / ticks << std::setw(14) << std::fixed << std::setprecision(3) << bruteMs
+            << std::setw(16) << gridPairs / ticks << std::setw(14) << gridMs
+            << std::setw(9) << std::setprecision(1) << (gridMs > 0 ? bruteMs / gridMs : 0.0) << "x"
+            << std::setw(8) << (bruteHits == gridHits ? std::to_string(gridHits) : "MISMATCH") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    return allMatch ? 0 : 1;
+}
+
+// The enemy layout before EnemyStore: one object per enemy owning a sprite
+struct LegacyEnemy {
+    sf::Sprite sprite;
+    float speed;
+    bool active;
+    EnemyType type;
+    int damage;
+
+    void update(float deltaTime, sf::Vector2f playerPos) {
+        if (active) {
+            sf::FloatRect bounds = sprite.getGlobalBounds();
+            sf::Vector2f enemyCenter(bounds.left + bounds.width / 2, bounds.top + bounds.height / 2);
+            sf::Vector2f direction = playerPos - enemyCenter;
+            float length = sqrt(direction.x * direction.x + direction.y * direction.y);
+            if (length > 0) {
+                direction /= length;
+                sprite.move(direction * speed * deltaTime);
+            }
+        }
+    }
+};
+
+// Enemy movement plus the enemy-vs-player test, object-per-enemy against
+// the structure-of-arrays store. Enemies are spread over a large area so
+// few of them reach the player during the run.
+inline int runEnemyLayoutBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int enemyCounts[] = { 10000, 50000, 100000 };
+    const int ticks = 100;
+    const float deltaTime = 1.0f / 60.0f;
+    const sf::Vector2f playerCenter(800, 450);
+    const sf::FloatRect playerBounds(770, 430, 60, 40);
+
+    std::cout << "Enemy update + player collision, " << ticks << " ticks\n"
+        << "bytes per enemy: objects " << sizeof(LegacyEnemy)
+        << ", arrays " << (3 * sizeof(float) + sizeof(int) + sizeof(EnemyType) + sizeof(sf::Uint8)) << "\n"
+        << std::setw(8) << "enemies" << std::setw(14) << "objects ms" << std::setw(14) << "arrays ms"
+        << std::setw(10) << "speedup" << "\n";
+
+    for (int enemyCount : enemyCounts) {
+        std::mt19937 rng(42);
+        EnemyStore store = makeBenchmarkHorde(art, enemyCount, rng);
+        for (int i = 0; i < enemyCount; i++) {
+            store.x[i] = store.x[i] * 20 - 16000;
+            store.y[i] = store.y[i] * 20 - 9000;
+        }
+
+        std::vector<LegacyEnemy> objects(enemyCount);
+        for (int i = 0; i < enemyCount; i++) {
+            store.applyToSprite(i, objects[i].sprite);
+            objects[i].speed = store.speed[i];
+            objects[i].active = true;
+            objects[i].type = store.type[i];
+            objects[i].damage = store.damage[i];
+        }
+
+        int objectHits = 0;
+        sf::Clock clock;
+        for (int tick = 0; tick < ticks; tick++) {
+            for (auto& enemy : objects) {
+                enemy.update(deltaTime, playerCenter);
+                if (enemy.active && checkCollision(enemy.sprite.getGlobalBounds(), playerBounds)) {
+                    enemy.active = false;
+                    objectHits++;
+                }
+            }
+        }
+        double objectMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+        int storeHits = 0;
+        clock.restart();
+        for (int tick = 0; tick < ticks; tick++) {
+            store.update(deltaTime, playerCenter);
+            for (int i = 0; i < store.count(); i++) {
+                if (store.active[i] && checkCollision(store.getBounds(i), playerBounds)) {
+                    store.active[i] = 0;
+                    storeHits++;
+                }
+            }
+        }
+        double storeMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+        std::cout << std::setw(8) << enemyCount
+            << std::setw(14) << std::fixed << std::setprecision(3) << objectMs << std::setw(14) << storeMs
+            << std::setw(9) << std::setprecision(1) << (storeMs > 0 ? objectMs / storeMs : 0.0) << "x"
+            << "  (hits " << objectHits << " / " << storeHits << ")\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+    return 0;
+}
+
+// Seek-toward-player sweep alone, once per kernel this CPU can run.
+// Every kernel must leave the enemies exactly where the scalar one does.
+inline int runSeekBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int enemyCounts[] = { 1000, 10000, 100000 };
+    const float deltaTime = 1.0f / 60.0f;
+    const sf::Vector2f playerCenter(800, 450);
+
+    std::cout << "Enemy seek kernel, best available: " << simdLevelName(bestSimdLevel()) << "\n"
+        << std::setw(8) << "enemies" << std::setw(8) << "kernel" << std::setw(14) << "enemies/us"
+        << std::setw(10) << "speedup" << std::setw(12) << "matches" << "\n";
+
+    bool allMatch = true;
+    for (int enemyCount : enemyCounts) {
+        const int ticks = 20000000 / enemyCount;
+        EnemyStore reference;
+        double scalarRate = 0;
+
+        for (int level = SIMD_SCALAR; level <= bestSimdLevel(); level++) {
+            std::mt19937 rng(42);
+            EnemyStore store = makeBenchmarkHorde(art, enemyCount, rng);
+            store.simdLevel = static_cast<SimdLevel>(level);
+
+            sf::Clock clock;
+            for (int tick = 0; tick < ticks; tick++) {
+                store.update(deltaTime, playerCenter);
+            }
+            double micros = static_cast<double>(clock.getElapsedTime().asMicroseconds());
+            double rate = micros > 0 ? static_cast<double>(enemyCount) * ticks / micros : 0;
+
+            bool matches = true;
+            if (level == SIMD_SCALAR) {
+                reference = store;
+                scalarRate = rate;
+            }
+            else {
+                matches = store.x == reference.x && store.y == reference.y;
+            }
+            allMatch = allMatch && matches;
+
+            std::cout << std::setw(8) << enemyCount << std::setw(8) << simdLevelName(static_cast<SimdLevel>(level))
+                << std::setw(14) << std::fixed << std::setprecision(1) << rate
+                << std::setw(9) << (scalarRate > 0 ? rate / scalarRate : 0.0) << "x"
+                << std::setw(12) << (matches ? "yes" : "NO") << "\n";
+            std::cout.unsetf(std::ios::fixed);
+        }
+    }
+    return allMatch ? 0 : 1;
+}
+
+// Firefight with a shot every tick: the old push_back/erase bullet vector
+// against BulletStore, counting heap allocations. The store must not
+// allocate at all, which is also checked for a whole World firefight once
+// it has warmed up.
+inline int runBulletBenchmark() {
+    const int ticks = 2400;
+    const int shotsPerTick = 4;
+    const sf::Vector2f origin(800, 450);
+
+    std::cout << "Bullet firefight, " << ticks << " ticks, " << shotsPerTick << " shots per tick\n"
+        << std::setw(10) << "storage" << std::setw(14) << "allocations" << std::setw(12) << "ms/tick"
+        << std::setw(14) << "peak bullets" << "\n";
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> angleDist(0, 6.2831853f);
+    std::vector<sf::Vector2f> directions(ticks * shotsPerTick);
+    for (auto& direction : directions) {
+        float angle = angleDist(rng);
+        direction = sf::Vector2f(cos(angle), sin(angle));
+    }
+
+    std::vector<LegacyBullet> vectorBullets;
+    size_t vectorPeak = 0;
+    long long before = heapAllocations();
+    sf::Clock clock;
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int shot = 0; shot < shotsPerTick; shot++) {
+            vectorBullets.push_back(LegacyBullet(origin.x, origin.y, directions[tick * shotsPerTick + shot]));
+        }
+        for (auto& bullet : vectorBullets) {
+            bullet.update(SIMULATION_STEP);
+        }
+        vectorBullets.erase(std::remove_if(vectorBullets.begin(), vectorBullets.end(),
+            [](const LegacyBullet& b) { return !b.active; }), vectorBullets.end());
+        vectorPeak = std::max(vectorPeak, vectorBullets.size());
+    }
+    double vectorMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+    long long vectorAllocations = heapAllocations() - before;
+
+    BulletStore store(2048);
+    int storePeak = 0;
+    before = heapAllocations();
+    clock.restart();
+    for (int tick = 0; tick < ticks; tick++) {
+        for (int shot = 0; shot < shotsPerTick; shot++) {
+            store.spawn(origin.x, origin.y, directions[tick * shotsPerTick + shot]);
+        }
+        store.update(SIMULATION_STEP);
+        store.compact();
+        storePeak = std::max(storePeak, store.count());
+    }
+    double storeMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+    long long storeAllocations = heapAllocations() - before;
+
+    std::cout << std::fixed << std::setprecision(4)
+        << std::setw(10) << "vector" << std::setw(14) << vectorAllocations << std::setw(12) << vectorMs << std::setw(14) << vectorPeak << "\n"
+        << std::setw(10) << "store" << std::setw(14) << storeAllocations << std::setw(12) << storeMs << std::setw(14) << storePeak << "\n";
+    std::cout.unsetf(std::ios::fixed);
+
+    World world(loadHeadlessArt(), 42);
+    world.start(PLAYING_TIME_TRIAL);
+    for (int tick = 0; tick < ticks; tick++) {
+        TickEvents events;
+        world.step(SIMULATION_STEP, autopilotInput(world, tick), events);
+    }
+    before = heapAllocations();
+    for (int tick = 0; tick < ticks; tick++) {
+        PlayerInput input = autopilotInput(world, tick);
+        input.shots = 1;
+        TickEvents events;
+        world.step(SIMULATION_STEP, input, events);
+        if (!world.isPlaying()) break;
+    }
+    long long worldAllocations = heapAllocations() - before;
+    std::cout << "World firefight after warm-up: " << worldAllocations << " allocations\n";
+
+    bool ok = storeAllocations == 0 && worldAllocations == 0;
+    std::cout << (ok ? "PASS" : "FAIL") << ": firing bullets " << (ok ? "does not allocate" : "allocated") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Full World ticks with a 50k horde on 1, 2, 4 and 8 threads. The parallel
+// sweeps merge their results in a fixed order, so every thread count must
+// end in exactly the same state as the single-threaded run.
+inline int runJobsBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int enemyCount = 50000;
+    const int ticks = 240;
+    const int threadCounts[] = { 1, 2, 4, 8 };
+
+    std::cout << "World tick with " << enemyCount << " enemies, " << ticks << " ticks, "
+        << std::thread::hardware_concurrency() << " hardware threads\n"
+        << std::setw(8) << "threads" << std::setw(12) << "ms/tick" << std::setw(10) << "speedup"
+        << std::setw(8) << "kills" << std::setw(12) << "matches" << "\n";
+
+    bool allMatch = true;
+    double serialMs = 0;
+    std::vector<float> referenceX, referenceY;
+    int referenceKills = 0, referenceHealth = 0;
+    for (int threads : threadCounts) {
+        JobSystem jobs(threads);
+        std::mt19937 rng(42);
+        World world(art, 42);
+        world.jobs = &jobs;
+        world.start(PLAYING_TIME_TRIAL);
+        world.enemies = makeBenchmarkHorde(art, enemyCount, rng);
+        world.player.maxHealth = world.player.health = 100000000; // survive the whole run
+
+        sf::Clock clock;
+        for (int tick = 0; tick < ticks; tick++) {
+            PlayerInput input;
+            float angle = tick * 0.05f;
+            input.aimTarget = world.player.getCenter() + sf::Vector2f(cos(angle), sin(angle));
+            input.shots = 2;
+            TickEvents events;
+            world.step(SIMULATION_STEP, input, events);
+        }
+        double ms = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+        bool matches = true;
+        if (threads == 1) {
+            serialMs = ms;
+            referenceX = world.enemies.x;
+            referenceY = world.enemies.y;
+            referenceKills = world.timeTrialKills;
+            referenceHealth = world.player.health;
+        }
+        else {
+            matches = world.enemies.x == referenceX && world.enemies.y == referenceY
+                && world.timeTrialKills == referenceKills && world.player.health == referenceHealth;
+        }
+        allMatch = allMatch && matches;
+
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(8) << threads << std::setw(12) << ms
+            << std::setprecision(2) << std::setw(9) << (ms > 0 ? serialMs / ms : 0.0) << "x"
+            << std::setw(8) << world.timeTrialKills << std::setw(12) << (matches ? "yes" : "NO") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+    return allMatch ? 0 : 1;
+}
+
+// Walls with alternating gaps across the arena, so the way to the player
+// from most places is a long detour rather than a straight line
+inline void buildBenchmarkMaze(FlowField& field) {
+    for (int column = 6; column < field.columnCount() - 3; column += 7) {
+        bool gapAtTop = (column / 7) % 2 == 0;
+        for (int row = 0; row < field.rowCount(); row++) {
+            bool inGap = gapAtTop ? row < 4 : row >= field.rowCount() - 4;
+            field.setBlocked(column, row, !inGap);
+        }
+    }
+}
+
+// 10k enemies following a flow field through a maze towards a player
+// walking in a circle. Reports the cost of one full rebuild, the per-tick
+// cost of following the field against seeking straight at the player, and
+// how rarely the field actually needs rebuilding.
+inline int runFlowFieldBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int enemyCount = 10000;
+    const int ticks = 1200;
+
+    FlowField field;
+    buildBenchmarkMaze(field);
+
+    const int rebuildRuns = 2000;
+    sf::Clock clock;
+    for (int i = 0; i < rebuildRuns; i++) {
+        field.update(sf::Vector2f(static_cast<float>(i % 1600), 450));
+    }
+    double rebuildMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / field.rebuilds;
+
+    std::mt19937 rng(42);
+    EnemyStore flowEnemies = makeBenchmarkHorde(art, enemyCount, rng);
+    EnemyStore seekEnemies = flowEnemies;
+    auto playerAt = [](int tick) {
+        float angle = tick * 0.01f;
+        return sf::Vector2f(800 + 300 * cos(angle), 450 + 300 * sin(angle));
+    };
+
+    field.rebuilds = 0;
+    clock.restart();
+    for (int tick = 0; tick < ticks; tick++) {
+        field.update(playerAt(tick));
+        flowEnemies.followFlow(SIMULATION_STEP, playerAt(tick), field);
+    }
+    double flowMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+    clock.restart();
+    for (int tick = 0; tick < ticks; tick++) {
+        seekEnemies.update(SIMULATION_STEP, playerAt(tick));
+    }
+    double seekMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+    int inWalls = 0, cutOff = 0;
+    for (int i = 0; i < enemyCount; i++) {
+        sf::Vector2f center = flowEnemies.getCenter(i);
+        int column = std::max(0, std::min(field.columnCount() - 1, static_cast<int>(center.x / field.getCellSize())));
+        int row = std::max(0, std::min(field.rowCount() - 1, static_cast<int>(center.y / field.getCellSize())));
+        if (field.isBlocked(column, row)) inWalls++;
+        else if (field.stepsToTarget(center) < 0) cutOff++;
+    }
+
+    std::cout << "Flow field, " << field.columnCount() << "x" << field.rowCount() << " cells, "
+        << enemyCount << " enemies, " << ticks << " ticks\n"
+        << std::fixed << std::setprecision(4)
+        << "full rebuild:           " << rebuildMs << " ms\n"
+        << "follow field:           " << flowMs << " ms/tick\n"
+        << "seek straight:          " << seekMs << " ms/tick\n"
+        << "rebuilds:               " << field.rebuilds << " in " << ticks << " ticks\n"
+        << "enemies inside walls:   " << inWalls << "\n"
+        << "enemies cut off:        " << cutOff << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+    return 0;
+}
+
+// Finding the enemies inside a 1600x900 camera view over a 9600x5400
+// arena: testing every enemy against the view, against asking the
+// collision grid for the cells under it. Both must find the same enemies.
+inline int runCullingBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const sf::Vector2f arenaSize(9600, 5400);
+    const int enemyCounts[] = { 10000, 50000, 200000 };
+    const int frames = 200;
+
+    std::cout << "View culling, " << arenaSize.x << "x" << arenaSize.y << " arena, 1600x900 view\n"
+        << std::setw(8) << "enemies" << std::setw(10) << "visible"
+        << std::setw(14) << "scan ms" << std::setw(14) << "grid ms" << std::setw(10) << "speedup"
+        << std::setw(12) << "matches" << "\n";
+
+    bool allMatch = true;
+    for (int enemyCount : enemyCounts) {
+        std::mt19937 rng(42);
+        EnemyStore enemies = makeBenchmarkHorde(art, enemyCount, rng, arenaSize);
+        SpatialHash grid(arenaSize.x, arenaSize.y);
+        grid.build(enemies.count(), [&](int i) { return enemies.getBounds(i); });
+
+        // The camera pans across the arena so every frame sees different enemies
+        auto viewAt = [&](int frame) {
+            float t = static_cast<float>(frame) / frames;
+            return sf::FloatRect(t * (arenaSize.x - 1600), 0.5f * t * (arenaSize.y - 900), 1600, 900);
+        };
+
+        long long scanVisible = 0;
+        sf::Clock clock;
+        for (int frame = 0; frame < frames; frame++) {
+            sf::FloatRect view = viewAt(frame);
+            for (int i = 0; i < enemies.count(); i++) {
+                if (enemies.active[i] && view.intersects(enemies.getBounds(i))) scanVisible++;
+            }
+        }
+        double scanMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / frames;
+
+        long long gridVisible = 0;
+        clock.restart();
+        for (int frame = 0; frame < frames; frame++) {
+            sf::FloatRect view = viewAt(frame);
+            grid.query(view, [&](int i) {
+                if (enemies.active[i] && view.intersects(enemies.getBounds(i))) gridVisible++;
+            });
+        }
+        double gridMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / frames;
+
+        bool matches = scanVisible == gridVisible;
+        allMatch = allMatch && matches;
+        std::cout << std::fixed << std::setprecision(4)
+            << std::setw(8) << enemyCount << std::setw(10) << gridVisible / frames
+            << std::setw(14) << scanMs << std::setw(14) << gridMs
+            << std::setprecision(1) << std::setw(9) << (gridMs > 0 ? scanMs / gridMs : 0.0) << "x"
+            << std::setw(12) << (matches ? "yes" : "NO") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+    return allMatch ? 0 : 1;
+}
+
+// The HUD over a 60 second time trial drawn at 60 fps: formatting every
+// value with ostringstream/to_string and calling setString each frame,
+// against HudText, which only formats into a stack buffer and calls
+// setString when the shown value changes. Counts heap allocations and
+// setString calls (each one makes SFML lay the glyphs out again).
+inline int runHudBenchmark() {
+    const int ticksPerFrame = 2;
+
+    struct HudValues {
+        int kills;
+        float timer;
+        bool hasSpeedBoost;
+        float speedBoostTimer;
+    };
+
+    // Record what the HUD shows each frame first, so both passes format the same values
+    std::vector<HudValues> frames;
+    World world(loadHeadlessArt(), 42);
+    world.start(PLAYING_TIME_TRIAL);
+    for (int tick = 0; world.isPlaying(); tick++) {
+        TickEvents events;
+        world.step(SIMULATION_STEP, autopilotInput(world, tick), events);
+        if (tick % ticksPerFrame == 0) {
+            frames.push_back({ world.timeTrialKills, world.timeTrialTimer, world.player.hasSpeedBoost, world.player.speedBoostTimer });
+        }
+    }
+    const int frameCount = static_cast<int>(frames.size());
+
+    std::cout << "HUD text, " << frameCount << " frames of a time trial\n"
+        << std::setw(10) << "hud" << std::setw(16) << "allocations" << std::setw(14) << "allocs/frame"
+        << std::setw(12) << "setString" << std::setw(12) << "ms/frame" << "\n";
+
+    sf::Text killCounterText, timerText, speedBoostText;
+    long long before = heapAllocations();
+    sf::Clock clock;
+    for (const HudValues& values : frames) {
+        std::ostringstream ss;
+        ss << "Time: " << std::fixed << std::setprecision(1) << values.timer;
+        timerText.setString(ss.str());
+        killCounterText.setString("Kills: " + std::to_string(values.kills));
+        speedBoostText.setString(values.hasSpeedBoost ?
+            "Speed Boost: " + (std::ostringstream() << std::fixed << std::setprecision(1) << values.speedBoostTimer << "s").str() :
+            "");
+    }
+    double formatMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / frameCount;
+    long long formatAllocations = heapAllocations() - before;
+    long long formatRelayouts = 3LL * frameCount;
+
+    HudText killCounter, timer, speedBoost;
+    before = heapAllocations();
+    clock.restart();
+    for (const HudValues& values : frames) {
+        timer.showTenths("Time: %.1f", values.timer);
+        killCounter.show("Kills: %d", values.kills);
+        if (values.hasSpeedBoost) {
+            speedBoost.showTenths("Speed Boost: %.1fs", values.speedBoostTimer);
+        }
+        else {
+            speedBoost.hide();
+        }
+    }
+    double cachedMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / frameCount;
+    long long cachedAllocations = heapAllocations() - before;
+    long long cachedRelayouts = killCounter.relayouts + timer.relayouts + speedBoost.relayouts;
+
+    std::cout << std::fixed << std::setprecision(4)
+        << std::setw(10) << "format" << std::setw(16) << formatAllocations << std::setw(14) << static_cast<double>(formatAllocations) / frameCount
+        << std::setw(12) << formatRelayouts << std::setw(12) << formatMs << "\n"
+        << std::setw(10) << "cached" << std::setw(16) << cachedAllocations << std::setw(14) << static_cast<double>(cachedAllocations) / frameCount
+        << std::setw(12) << cachedRelayouts << std::setw(12) << cachedMs << "\n";
+    std::cout.unsetf(std::ios::fixed);
+
+    bool ok = cachedAllocations < formatAllocations && cachedRelayouts < formatRelayouts;
+    std::cout << (ok ? "PASS" : "FAIL") << ": cached HUD " << (ok ? "formats less" : "did not help") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Startup: loading the game's textures, plus the full-screen images in the
+// repo to show a heavier set, all on the main thread against the
+// AssetLoader with decoding on worker threads, from loose files and from
+// an archive of pre-decoded images. Reports when the first frame could be
+// drawn, when everything is loaded, and the longest the main thread goes
+// without being able to draw.
+inline int runStartupBenchmark() {
+    const char* largeImages[] = { "background_welcome.png", "background_playing.png", "background_win.png",
+        "background_lose.png", "ground3.png", "welcome.jpg" };
+    const int imageCount = sizeof(largeImages) / sizeof(largeImages[0]);
+    const int workerCount = std::min(4, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+
+    // The archive holds the same images, decoded, under their file names
+    const char* archiveName = "startup-bench.pak";
+    const char* gameImages[] = { "player.png", "enemy1.png", "enemy2.png", "health.png", "speed.png",
+        "floor.png", "wall.png", "destructible.png" };
+    AssetArchiveWriter writer;
+    for (const char* file : gameImages) writer.addFile(file, true);
+    for (const char* file : largeImages) writer.addFile(file, true);
+    if (!writer.write(archiveName)) {
+        std::cout << "Could not write " << archiveName << std::endl;
+        return 1;
+    }
+    AssetArchive packed;
+    packed.open(archiveName);
+    AssetArchive noArchive;
+
+    std::cout << "Startup, game textures + " << imageCount << " full-screen images, " << workerCount << " loader threads\n"
+        << std::setw(12) << "loading" << std::setw(16) << "first frame ms" << std::setw(14) << "loaded ms"
+        << std::setw(18) << "longest stall ms" << "\n";
+
+    bool ok = true;
+    enum Loading { MAIN_THREAD, ASYNC, ASYNC_ARCHIVE };
+    for (Loading loading : { MAIN_THREAD, ASYNC, ASYNC_ARCHIVE }) {
+        const AssetArchive& archive = loading == ASYNC_ARCHIVE ? packed : noArchive;
+        TextureManager textures;
+        std::vector<sf::Image> images(imageCount);
+        std::vector<sf::Texture> imageTextures(imageCount);
+
+        sf::Clock clock;
+        AssetLoader loader;
+        textures.queue(loader, archive);
+        for (int i = 0; i < imageCount; i++) {
+            loader.add([&images, &largeImages, &archive, i] {
+                if (!archive.loadImage(images[i], largeImages[i])) images[i].loadFromFile(largeImages[i]);
+            },
+                [&images, &imageTextures, i] { imageTextures[i].loadFromImage(images[i]); });
+        }
+
+        double firstFrameMs, longestStallMs;
+        if (loading == MAIN_THREAD) {
+            // Nothing can be drawn until every asset is in
+            loader.finish();
+            firstFrameMs = longestStallMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+        }
+        else {
+            // One pass of the loading screen loop per "frame", minus the drawing
+            loader.start(workerCount);
+            firstFrameMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+            longestStallMs = firstFrameMs;
+            while (!loader.done()) {
+                sf::Clock frameClock;
+                loader.uploadReady(4);
+                longestStallMs = std::max(longestStallMs, frameClock.getElapsedTime().asMicroseconds() / 1000.0);
+                std::this_thread::yield();
+            }
+        }
+        double loadedMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+        ok = ok && textures.atlas.rect("player").width > 0 && textures.backgroundTexture.getSize().x > 0;
+
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(12) << (loading == MAIN_THREAD ? "main thread" : loading == ASYNC ? "async" : "async pak") << std::setw(16) << firstFrameMs
+            << std::setw(14) << loadedMs << std::setw(18) << longestStallMs << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+    packed.close();
+    std::remove(archiveName);
+    return ok ? 0 : 1;
+}
+
+// Bullets at 10x speed with the simulation stepped at 30 fps, so a bullet
+// moves 200 px per tick, several times a zombie's width. Each trial fires
+// one bullet straight at a lone zombie, far enough out that it cannot
+// reach the player first, and every one must hit it; the
+// old end-of-tick overlap test is replayed along the same path to show
+// how many it would have missed. Then times the swept hit lookup against
+// the overlap lookup at normal speed, over a 10k horde.
+inline int runTunnellingBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int trials = 1000;
+    const int ticksPerSecond = 30;
+    const float tick = 1.0f / ticksPerSecond;
+    const float speed = 6000;
+
+    World world(art, 42);
+    world.bulletSpeed = speed;
+    world.enemySpawnDelay = 1000;
+    world.powerupSpawnDelay = 1000;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> angleDist(0, 6.2831853f);
+    std::uniform_real_distribution<float> rangeDist(0.5f, 1.0f);
+
+    int sweptHits = 0, overlapHits = 0;
+    for (int trial = 0; trial < trials; trial++) {
+        world.start(PLAYING_TIME_TRIAL);
+        sf::Vector2f origin = world.player.getCenter();
+        float angle = angleDist(rng);
+        float range = rangeDist(rng);
+        world.enemies.spawn(origin.x + cos(angle) * 650 * range - 20, origin.y + sin(angle) * 380 * range - 20, ENEMY_TYPE_1, rng);
+        sf::Vector2f enemySize(world.enemies.getBounds(0).width, world.enemies.getBounds(0).height);
+
+        PlayerInput input;
+        input.aimTarget = world.enemies.getCenter(0);
+        input.shots = 1;
+        sf::Vector2f direction = normalize(input.aimTarget - origin);
+        for (int step = 1; step <= 10 && world.enemies.count() > 0; step++) {
+            TickEvents events;
+            world.step(tick, input, events);
+            input.shots = 0;
+            if (events.enemiesKilled == 0) continue;
+            sweptHits++;
+
+            // Would the bullet have overlapped the zombie where it stopped at the end of any tick?
+            sf::Vector2f killed = events.killPositions[0];
+            sf::FloatRect enemyBounds(killed.x - enemySize.x / 2, killed.y - enemySize.y / 2, enemySize.x, enemySize.y);
+            for (int k = 1; k <= step; k++) {
+                sf::Vector2f center = origin + direction * speed * tick * static_cast<float>(k);
+                if (checkCollision(sf::FloatRect(center.x - 4, center.y - 4, 8, 8), enemyBounds)) {
+                    overlapHits++;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::cout << "Tunnelling, " << trials << " shots at a lone zombie, " << speed << " px/s bullets, "
+        << ticksPerSecond << " ticks per second (" << speed * tick << " px per tick)\n"
+        << std::setw(14) << "test" << std::setw(8) << "hits" << std::setw(10) << "missed" << "\n"
+        << std::setw(14) << "overlap" << std::setw(8) << overlapHits << std::setw(10) << trials - overlapHits << "\n"
+        << std::setw(14) << "swept" << std::setw(8) << sweptHits << std::setw(10) << trials - sweptHits << "\n";
+
+    // Cost at normal speed: every bullet against a 10k horde through the grid
+    const int enemyCount = 10000;
+    const int bulletCount = 256;
+    const int repeats = 100;
+    World horde(art, 42);
+    horde.enemies = makeBenchmarkHorde(art, enemyCount, rng);
+    horde.enemyGrid.build(enemyCount, [&horde](int i) { return horde.enemies.getBounds(i); });
+    BulletStore bullets = makeBenchmarkBulletStore(bulletCount, rng);
+    bullets.update(SIMULATION_STEP);
+
+    int overlapFound = 0, sweptFound = 0;
+    sf::Clock clock;
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        overlapFound = 0;
+        for (int b = 0; b < bullets.count(); b++) {
+            if (!bullets.active[b]) continue;
+            sf::FloatRect bounds = bullets.bounds[b];
+            int hit = -1;
+            horde.enemyGrid.query(bounds, [&](int i) {
+                if ((hit < 0 || i < hit) && checkCollision(bounds, horde.enemies.getBounds(i))) hit = i;
+            });
+            if (hit >= 0) overlapFound++;
+        }
+    }
+    double overlapMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / repeats;
+    clock.restart();
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        sweptFound = 0;
+        for (int b = 0; b < bullets.count(); b++) {
+            if (bullets.active[b] && horde.findBulletHit(bullets, b) >= 0) sweptFound++;
+        }
+    }
+    double sweptMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / repeats;
+    std::cout << std::fixed << std::setprecision(4)
+        << "Hit lookup, " << bulletCount << " bullets vs " << enemyCount << " enemies at 600 px/s: overlap "
+        << overlapMs << " ms (" << overlapFound << " hits), swept " << sweptMs << " ms (" << sweptFound << " hits)\n";
+    std::cout.unsetf(std::ios::fixed);
+
+    bool ok = sweptHits == trials;
+    std::cout << (ok ? "PASS" : "FAIL") << ": fast bullets " << (ok ? "never tunnel" : "tunnelled") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Enemies closer to another enemy's centre than this count as stacked
+inline int countStackedEnemies(const EnemyStore& enemies, const SpatialHash& grid, float within) {
+    int stacked = 0;
+    for (int i = 0; i < enemies.count(); i++) {
+        sf::Vector2f center = enemies.getCenter(i);
+        bool found = false;
+        grid.query(sf::FloatRect(center.x - within, center.y - within, within * 2, within * 2), [&](int j) {
+            if (j == i || found) return;
+            sf::Vector2f other = enemies.getCenter(j);
+            if ((center.x - other.x) * (center.x - other.x) + (center.y - other.y) * (center.y - other.y) < within * within) found = true;
+        });
+        if (found) stacked++;
+    }
+    return stacked;
+}
+
+// Crowd separation at 5k, 20k and 100k enemies, with the arena grown to
+// keep the crowd equally dense, on one thread and including the grid
+// build. Working out every enemy's push by testing every pair (a grid with
+// a single cell) against querying the spatial hash, then the cost per tick
+// as the game runs it, with a share of the pushes redone each tick. Then
+// 2000 enemies walk in on one point for 5 seconds, with and without
+// separation, counting how many end up stacked.
+inline int runCrowdBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int enemyCounts[] = { 5000, 20000, 100000 };
+    const int bruteLimit = 20000; // every pair beyond this takes too long to be worth timing
+    JobSystem oneThread(1);
+
+    std::cout << "Crowd separation, radius " << EnemyStore().separationRadius << ", nearest " << EnemyStore().separationNeighbours
+        << " neighbours, one thread\n"
+        << std::setw(8) << "enemies" << std::setw(14) << "arena" << std::setw(14) << "pairs ms"
+        << std::setw(14) << "grid ms" << std::setw(10) << "speedup" << std::setw(14) << "ms/tick" << "\n";
+
+    bool ok = true;
+    for (int enemyCount : enemyCounts) {
+        float grow = std::sqrt(enemyCount / 5000.0f);
+        sf::Vector2f arenaSize(1600 * grow, 900 * grow);
+        std::mt19937 rng(42);
+        EnemyStore enemies = makeBenchmarkHorde(art, enemyCount, rng, arenaSize);
+
+        double pairsMs = -1;
+        if (enemyCount <= bruteLimit) {
+            EnemyStore copy = enemies;
+            copy.separationCandidates = enemyCount; // every pair, not just the nearest few
+            copy.separationInterval = 1;
+            sf::Clock clock;
+            SpatialHash everything(arenaSize.x, arenaSize.y, std::max(arenaSize.x, arenaSize.y));
+            everything.build(copy.count(), [&](int i) { return copy.getBounds(i); });
+            copy.separate(SIMULATION_STEP, everything, oneThread);
+            pairsMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+        }
+
+        SpatialHash grid(arenaSize.x, arenaSize.y);
+        EnemyStore copy = enemies;
+        copy.separationInterval = 1;
+        sf::Clock clock;
+        grid.build(copy.count(), [&](int i) { return copy.getBounds(i); });
+        copy.separate(SIMULATION_STEP, grid, oneThread);
+        double gridMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+        ok = ok && (pairsMs < 0 || gridMs < pairsMs);
+
+        const int ticks = 20;
+        clock.restart();
+        for (int tick = 0; tick < ticks; tick++) {
+            grid.build(enemies.count(), [&](int i) { return enemies.getBounds(i); });
+            enemies.separate(SIMULATION_STEP, grid, oneThread);
+        }
+        double tickMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / ticks;
+
+        std::ostringstream arena;
+        arena << static_cast<int>(arenaSize.x) << "x" << static_cast<int>(arenaSize.y);
+        std::cout << std::fixed << std::setprecision(4)
+            << std::setw(8) << enemyCount << std::setw(14) << arena.str();
+        if (pairsMs >= 0) std::cout << std::setw(14) << pairsMs << std::setw(14) << gridMs
+            << std::setprecision(1) << std::setw(9) << pairsMs / gridMs << "x";
+        else std::cout << std::setw(14) << "-" << std::setw(14) << gridMs << std::setw(10) << "-";
+        std::cout << std::setprecision(4) << std::setw(14) << tickMs << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    const int converging = 2000;
+    const sf::Vector2f target(800, 450);
+    int stacked[2];
+    for (int separated = 0; separated < 2; separated++) {
+        std::mt19937 rng(42);
+        EnemyStore enemies = makeBenchmarkHorde(art, converging, rng);
+        if (!separated) enemies.separationRadius = 0;
+        SpatialHash grid;
+        for (int tick = 0; tick < 600; tick++) {
+            grid.build(enemies.count(), [&](int i) { return enemies.getBounds(i); });
+            enemies.separate(SIMULATION_STEP, grid, oneThread);
+            enemies.update(SIMULATION_STEP, target);
+        }
+        grid.build(enemies.count(), [&](int i) { return enemies.getBounds(i); });
+        stacked[separated] = countStackedEnemies(enemies, grid, 4);
+    }
+    std::cout << converging << " enemies after 5 s walking to one point, stacked within 4 px of another: "
+        << stacked[0] << " seeking only, " << stacked[1] << " with separation\n";
+    ok = ok && stacked[1] < stacked[0];
+
+    std::cout << (ok ? "PASS" : "FAIL") << ": separation " << (ok ? "spreads the crowd in near-linear time" : "did not help") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// A burst wave of 2000 zombies, spawned all in one tick against spread
+// over ticks by the wave director's spawn budget, plus the cost of picking
+// spawn points with distributions built per spawn against prebuilt ones
+inline int runWavesBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int ticks = 240;
+    const int runs = 3; // the best of these, since noise only adds to a worst tick
+    // Each burst unbudgeted and then budgeted. 2000 zombies land in one
+    // tick cheaply enough either way; 50000 make that one tick spike.
+    struct Burst {
+        int waveSize;
+        int budget;
+    };
+    const Burst bursts[4] = { { 2000, 2000 }, { 2000, 16 }, { 50000, 50000 }, { 50000, 400 } };
+
+    std::cout << "Waves, one burst of zombies, " << ticks << " ticks, best of " << runs << " runs\n"
+        << std::setw(10) << "zombies" << std::setw(10) << "budget" << std::setw(14) << "worst tick" << std::setw(14) << "most/tick"
+        << std::setw(16) << "ticks to land" << "\n";
+    bool ok = true;
+    double unbudgetedWorstMs = 0;
+    for (const Burst& burst : bursts) {
+        double worstMs = 0;
+        int mostInTick = 0, landedBy = -1;
+        for (int run = 0; run < runs; run++) {
+            World world(art, 42);
+            world.powerupSpawnDelay = 1000;
+            std::ostringstream config;
+            config << "budget " << burst.budget << "\nwave count=" << burst.waveSize << " time=0 ramp=burst pause=1000\n";
+            world.waves.loadFromString(config.str());
+            world.start(PLAYING_TIME_TRIAL, 42);
+
+            double runWorstMs = 0;
+            mostInTick = 0;
+            landedBy = -1;
+            for (int tick = 0; tick < ticks; tick++) {
+                world.player.health = 1000000;
+                PlayerInput input;
+                input.aimTarget = world.player.proxy.center + sf::Vector2f(1, 0);
+                TickEvents events;
+                int before = world.enemiesSpawned;
+                sf::Clock clock;
+                world.step(SIMULATION_STEP, input, events);
+                runWorstMs = std::max(runWorstMs, clock.getElapsedTime().asMicroseconds() / 1000.0);
+                mostInTick = std::max(mostInTick, world.enemiesSpawned - before);
+                if (landedBy < 0 && world.enemiesSpawned == burst.waveSize) landedBy = tick + 1;
+            }
+            worstMs = run == 0 ? runWorstMs : std::min(worstMs, runWorstMs);
+        }
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << burst.waveSize << std::setw(10) << burst.budget << std::setw(11) << worstMs << " ms"
+            << std::setw(14) << mostInTick << std::setw(16) << landedBy << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        ok = ok && mostInTick <= burst.budget && landedBy > 0;
+        if (burst.budget == burst.waveSize) {
+            unbudgetedWorstMs = worstMs;
+        }
+        else if (burst.waveSize == 50000) {
+            // The spike the budget is there to flatten
+            ok = ok && worstMs < unbudgetedWorstMs;
+        }
+    }
+
+    // Spawn points and types as the spawn branch used to pick them, against
+    // the director's prebuilt distributions: without waves it must draw
+    // exactly the same ones
+    const int picks = 1000000;
+    sf::Vector2f arenaSize(1600, 900);
+    std::mt19937 rng(42);
+    double perSpawnSum = 0;
+    sf::Clock clock;
+    for (int i = 0; i < picks; i++) {
+        std::uniform_int_distribution<int> edgeDist(0, 3);
+        std::uniform_real_distribution<float> posDist(0, arenaSize.x);
+        std::uniform_real_distribution<float> posYDist(0, arenaSize.y);
+        float x = 0, y = 0;
+        switch (edgeDist(rng)) {
+        case 0: x = posDist(rng); y = 0; break;
+        case 1: x = arenaSize.x; y = posYDist(rng); break;
+        case 2: x = posDist(rng); y = arenaSize.y; break;
+        case 3: x = 0; y = posYDist(rng); break;
+        }
+        std::uniform_int_distribution<int> typeDist(0, 99);
+        perSpawnSum += x + y + (typeDist(rng) < 60 ? 0 : 1);
+    }
+    double perSpawnMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+
+    WaveDirector director;
+    director.setArenaSize(arenaSize);
+    rng.seed(42);
+    double prebuiltSum = 0;
+    clock.restart();
+    for (int i = 0; i < picks; i++) {
+        sf::Vector2f point = director.pickSpawnPoint(rng);
+        prebuiltSum += point.x + point.y + (director.pickType(rng) == ENEMY_TYPE_1 ? 0 : 1);
+    }
+    double prebuiltMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+
+    director.loadFromString("wave types=60,40 edges=2,1,1,2\n");
+    double biasedSum = 0;
+    clock.restart();
+    for (int i = 0; i < picks; i++) {
+        sf::Vector2f point = director.pickSpawnPoint(rng);
+        biasedSum += point.x + point.y + (director.pickType(rng) == ENEMY_TYPE_1 ? 0 : 1);
+    }
+    double biasedMs = clock.getElapsedTime().asMicroseconds() / 1000.0;
+    std::cout << std::fixed << std::setprecision(2)
+        << picks << " spawn points and types: distributions built per spawn " << perSpawnMs << " ms, prebuilt "
+        << prebuiltMs << " ms (" << (prebuiltSum == perSpawnSum ? "same" : "DIFFERENT") << " draws), with a wave's edge and type weights "
+        << biasedMs << " ms (checksum " << biasedSum << ")\n";
+    std::cout.unsetf(std::ios::fixed);
+    ok = ok && prebuiltSum == perSpawnSum;
+
+    std::cout << (ok ? "PASS" : "FAIL") << ": " << (ok ? "the bursts landed within the spawn budget without the unbudgeted spike, trickle spawns unchanged" : "spawning broke the budget, spiked or changed") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// The powerup before PowerupStore: an object owning its own sprite
+class LegacyPowerup {
+public:
+    sf::Sprite sprite;
+    PowerupType type;
+    bool active;
+    float lifetime;
+    CollisionProxy proxy; // refreshed whenever update() rescales the sprite
+
+    LegacyPowerup(float x, float y, PowerupType powerupType, const SpriteArt& art) {
+        type = powerupType;
+        active = true;
+        lifetime = 10.0f;
+
+        art.applyTo(sprite);
+        sprite.setPosition(x, y);
+        sprite.setScale(0.1f, 0.1f); // Increased for visibility
+        proxy.set(sprite.getGlobalBounds());
+    }
+
+    void update(float deltaTime) {
+        lifetime -= deltaTime;
+        if (lifetime <= 0) {
+            active = false;
+        }
+        float pulse = sin(lifetime * 5) * 0.02f + 1.0f;
+        sprite.setScale(0.12f * pulse, 0.12f * pulse);
+        proxy.set(sprite.getGlobalBounds());
+    }
+
+    sf::FloatRect getBounds() const {
+        return proxy.bounds;
+    }
+};
+
+// Two pieces of work timed over the same runs
+struct PairTiming {
+    double bestA = -1; // fastest run, ms
+    double bestB = -1;
+    double ratio = 1;  // median over the runs of B's time over A's
+};
+
+// Runs a and b, runs times over. Each ratio compares two runs made back to
+// back, so load from elsewhere on the machine slows both alike, and the
+// median keeps a stray context switch from deciding the comparison. Which
+// goes first alternates, since the second of a pair runs a few percent
+// faster on data the first left in the cache.
+template <typename WorkA, typename WorkB>
+PairTiming timePair(int runs, WorkA workA, WorkB workB) {
+    PairTiming timing;
+    std::vector<double> ratios;
+    for (int run = 0; run < runs; run++) {
+        double msA = 0, msB = 0;
+        sf::Clock clock;
+        if (run % 2 == 0) {
+            workA();
+            msA = clock.getElapsedTime().asMicroseconds() / 1000.0;
+            clock.restart();
+            workB();
+            msB = clock.getElapsedTime().asMicroseconds() / 1000.0;
+        }
+        else {
+            workB();
+            msB = clock.getElapsedTime().asMicroseconds() / 1000.0;
+            clock.restart();
+            workA();
+            msA = clock.getElapsedTime().asMicroseconds() / 1000.0;
+        }
+        if (timing.bestA < 0 || msA < timing.bestA) timing.bestA = msA;
+        if (timing.bestB < 0 || msB < timing.bestB) timing.bestB = msB;
+        ratios.push_back(msA > 0 ? msB / msA : 1.0);
+    }
+    std::sort(ratios.begin(), ratios.end());
+    timing.ratio = ratios[ratios.size() / 2];
+    return timing;
+}
+
+// Iterating the ECS tables with each<> against the layouts they replaced:
+// the enemy arrays walked by hand, a vector of bullet objects, a vector of
+// powerup objects, and all three containers visited one after another
+// against one registry-wide each<>. Every pair does the same arithmetic and
+// must end with the same checksum. Also checks that handles follow their
+// entities through compaction and go stale once they are destroyed.
+inline int runEcsBenchmark() {
+    GameArt art = loadHeadlessArt();
+    const int enemyCount = 100000;
+    const int bulletCount = 20000;
+    const int powerupCount = 20000;
+    const int ticks = 20;
+    const int runs = 31;
+    const float noiseMargin = 0.03f; // a median ratio above 1 by less than this is noise
+
+    std::cout << "ECS iteration, " << ticks << " ticks, best of " << runs << " runs and median ratio, "
+        << noiseMargin * 100 << "% noise margin\n"
+        << std::setw(10) << "entities" << std::setw(10) << "count" << std::setw(14) << "before ms"
+        << std::setw(14) << "each<> ms" << std::setw(10) << "ratio" << "\n";
+
+    bool ok = true;
+    auto report = [&](const char* name, int count, const PairTiming& timing, bool same) {
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << name << std::setw(10) << count << std::setw(14) << timing.bestA
+            << std::setw(14) << timing.bestB << std::setw(9) << std::setprecision(2) << timing.ratio << "x"
+            << (same ? "" : "  MISMATCH") << "\n";
+        std::cout.unsetf(std::ios::fixed);
+        ok = ok && same && timing.ratio <= 1 + noiseMargin;
+    };
+
+    // Enemies: the interpolation save and a step along x, by index as the
+    // game's loops did and through each<>
+    std::mt19937 rng(42);
+    EnemyStore indexed = makeBenchmarkHorde(art, enemyCount, rng);
+    EnemyStore viaEach = indexed;
+    PairTiming enemyTiming = timePair(runs, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            for (int i = 0; i < indexed.count(); i++) {
+                if (!indexed.active[i]) continue;
+                indexed.previousX[i] = indexed.x[i];
+                indexed.previousY[i] = indexed.y[i];
+                indexed.x[i] += indexed.speed[i] * SIMULATION_STEP;
+            }
+        }
+    }, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            viaEach.each<POSITION_X, POSITION_Y, PREVIOUS_X, PREVIOUS_Y, SPEED>(
+                [](float& x, float y, float& previousX, float& previousY, float speed) {
+                    previousX = x;
+                    previousY = y;
+                    x += speed * SIMULATION_STEP;
+                });
+        }
+    });
+    report("enemies", enemyCount, enemyTiming, indexed.x == viaEach.x && indexed.previousX == viaEach.previousX);
+
+    // Bullets: the object vector updated bullet by bullet, against the
+    // store's columns. The arena is large enough that none leave it.
+    const sf::Vector2f bigArena(1e9f, 1e9f);
+    std::mt19937 bulletRng(7);
+    std::vector<LegacyBullet> bulletObjects = makeBenchmarkBullets(bulletCount, bulletRng);
+    bulletRng.seed(7);
+    BulletStore bulletStore = makeBenchmarkBulletStore(bulletCount, bulletRng);
+    PairTiming bulletTiming = timePair(runs, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            for (auto& bullet : bulletObjects) {
+                bullet.update(SIMULATION_STEP, bigArena);
+            }
+        }
+    }, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            bulletStore.update(SIMULATION_STEP, bigArena);
+        }
+    });
+    bool bulletsSame = true;
+    for (int i = 0; i < bulletCount; i++) {
+        sf::Vector2f position = bulletObjects[i].shape.getPosition();
+        bulletsSame = bulletsSame && position.x == bulletStore.x[i] && position.y == bulletStore.y[i];
+    }
+    report("bullets", bulletCount, bulletTiming, bulletsSame);
+
+    // Powerups: pulsing objects against the store. Lifetimes are long
+    // enough to outlast every run.
+    std::uniform_real_distribution<float> xDist(100, 1500);
+    std::uniform_real_distribution<float> yDist(100, 800);
+    std::vector<LegacyPowerup> powerupObjects;
+    powerupObjects.reserve(powerupCount);
+    PowerupStore powerupStore;
+    powerupStore.setArt(art.health, art.speed);
+    powerupStore.reserve(powerupCount);
+    for (int i = 0; i < powerupCount; i++) {
+        PowerupType type = (i % 2 == 0) ? HEALTH_BOOST : SPEED_BOOST;
+        float x = xDist(rng);
+        float y = yDist(rng);
+        powerupObjects.emplace_back(x, y, type, type == HEALTH_BOOST ? art.health : art.speed);
+        powerupObjects.back().lifetime = 1000;
+        powerupStore.lifetime[powerupStore.spawn(x, y, type)] = 1000;
+    }
+    PairTiming powerupTiming = timePair(runs, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            for (auto& powerup : powerupObjects) {
+                powerup.update(SIMULATION_STEP);
+            }
+        }
+    }, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            powerupStore.update(SIMULATION_STEP);
+        }
+    });
+    bool powerupsSame = true;
+    for (int i = 0; i < powerupCount; i++) {
+        const sf::FloatRect& a = powerupObjects[i].getBounds();
+        const sf::FloatRect& b = powerupStore.bounds[i];
+        powerupsSame = powerupsSame && a.left == b.left && a.top == b.top && a.width == b.width && a.height == b.height;
+    }
+    report("powerups", powerupCount, powerupTiming, powerupsSame);
+
+    // A system over every positioned entity: each container by hand, then
+    // one each<> over the registry's matching tables
+    EntityRegistry registry;
+    registry.table<EnemyStore>() = viaEach;
+    registry.table<BulletStore>() = bulletStore;
+    registry.table<PowerupStore>() = powerupStore;
+    double handSum = 0, registrySum = 0;
+    PairTiming allTiming = timePair(runs, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            double sum = 0;
+            const EnemyStore& e = registry.table<EnemyStore>();
+            for (int i = 0; i < e.count(); i++) {
+                if (e.active[i]) sum += e.x[i] + e.y[i];
+            }
+            const BulletStore& b = registry.table<BulletStore>();
+            for (int i = 0; i < b.count(); i++) {
+                if (b.active[i]) sum += b.x[i] + b.y[i];
+            }
+            const PowerupStore& p = registry.table<PowerupStore>();
+            for (int i = 0; i < p.count(); i++) {
+                if (p.active[i]) sum += p.x[i] + p.y[i];
+            }
+            handSum = sum;
+        }
+    }, [&]() {
+        for (int tick = 0; tick < ticks; tick++) {
+            double sum = 0;
+            registry.each<POSITION_X, POSITION_Y>([&sum](float x, float y) { sum += x + y; });
+            registrySum = sum;
+        }
+    });
+    report("all", enemyCount + bulletCount + powerupCount, allTiming, handSum == registrySum);
+
+    // Handles: destroy every third enemy, compact, and check the rest
+    // still find their own rows while the destroyed ones are refused
+    EntityRegistry handles;
+    EnemyStore& enemies = handles.table<EnemyStore>();
+    enemies.setArt(art.enemy1, art.enemy2);
+    std::vector<Entity> spawned;
+    std::vector<float> spawnX;
+    for (int i = 0; i < 1000; i++) {
+        float x = static_cast<float>(i);
+        spawned.push_back(handles.add<EnemyStore>([&](Entity entity) {
+            return enemies.spawn(x, 0, ENEMY_TYPE_1, rng, entity);
+        }));
+        spawnX.push_back(x);
+    }
+    for (int i = 0; i < 1000; i += 3) {
+        handles.destroy(spawned[i]);
+    }
+    handles.compact();
+    bool handlesOk = handles.liveCount() == 1000 - 334;
+    for (int i = 0; i < 1000; i++) {
+        float* x = handles.get<POSITION_X>(spawned[i]);
+        handlesOk = handlesOk && (i % 3 == 0 ? x == nullptr && !handles.isAlive(spawned[i]) : x != nullptr && *x == spawnX[i]);
+    }
+    // A freed slot is reused under a new generation, which the old handle does not match
+    Entity reused = handles.add<EnemyStore>([&](Entity entity) {
+        return enemies.spawn(-1, 0, ENEMY_TYPE_2, rng, entity);
+    });
+    handlesOk = handlesOk && reused.index == spawned[999].index && reused.generation == spawned[999].generation + 1
+        && handles.isAlive(reused) && !handles.isAlive(spawned[999]);
+    std::cout << "Handles after destroying 334 of 1000 enemies and compacting: " << (handlesOk ? "all resolve correctly" : "WRONG") << "\n";
+    ok = ok && handlesOk;
+
+    std::cout << (ok ? "PASS" : "FAIL") << ": " << (ok ? "each<> iterates as fast as the old layouts or faster, within the noise margin" : "each<> was slower or disagreed") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Walls on the sample level. The player first walks round the arena pressed
+// against its edges, facing each way in turn, where the arena clamp meets the
+// wall tiles; then the autopilot plays rounds with zombies pathing round
+// the walls. Nothing may move into a wall: the player's footprint must
+// never overlap one, and no zombie's bounds may go from open ground into one.
+inline int runWallsBenchmark() {
+    World world(loadHeadlessArt(), 42);
+    if (!world.loadLevel("arena.txt")) {
+        std::cout << "FAIL: could not load arena.txt" << std::endl;
+        return 1;
+    }
+    world.enemySpawnDelay = 1000;
+    world.powerupSpawnDelay = 1000;
+    world.timeTrialDuration = 1000;
+    world.start(PLAYING_TIME_TRIAL, 42);
+
+    // Clockwise round the edges, each leg pushing into the edge it follows
+    const sf::Vector2f legs[4] = { sf::Vector2f(1, -1), sf::Vector2f(1, 1), sf::Vector2f(-1, 1), sf::Vector2f(-1, -1) };
+    const int legTicks = 1000;
+    const int edgeTicks = 2 * 4 * legTicks;
+    int edgeOverlaps = 0;
+    for (int tick = 0; tick < edgeTicks; tick++) {
+        PlayerInput input;
+        input.movement = legs[(tick / legTicks) % 4];
+        float angle = (tick / 125) * 0.7853982f; // an eighth of a turn at a time
+        input.aimTarget = world.player.proxy.center + sf::Vector2f(cos(angle), sin(angle)) * 100.0f;
+        TickEvents events;
+        world.step(SIMULATION_STEP, input, events);
+        if (world.tiles.overlapsSolid(world.player.getFootprint())) edgeOverlaps++;
+    }
+
+    World round(loadHeadlessArt(), 42);
+    round.loadLevel("arena.txt");
+    round.start(PLAYING_TIME_TRIAL, 42);
+    const int roundTicks = 36000;
+    int roundOverlaps = 0, enemyEntries = 0;
+    for (int tick = 0; tick < roundTicks; tick++) {
+        TickEvents events;
+        round.step(SIMULATION_STEP, autopilotInput(round, tick), events);
+        if (round.tiles.overlapsSolid(round.player.getFootprint())) roundOverlaps++;
+        const EnemyStore& enemies = round.enemies;
+        for (int i = 0; i < enemies.count(); i++) {
+            sf::FloatRect bounds = enemies.getBounds(i);
+            sf::FloatRect before(enemies.previousX[i], enemies.previousY[i], bounds.width, bounds.height);
+            if (!round.tiles.overlapsSolid(before) && round.tiles.overlapsSolid(bounds)) enemyEntries++;
+        }
+        if (!round.isPlaying()) round.start(PLAYING_TIME_TRIAL);
+    }
+
+    std::cout << "Walls on arena.txt\n"
+        << "player footprint in a wall: " << edgeOverlaps << " of " << edgeTicks << " ticks walking the edges, "
+        << roundOverlaps << " of " << roundTicks << " ticks of autopilot\n"
+        << "zombies moved into a wall:  " << enemyEntries << "\n";
+
+    bool ok = edgeOverlaps == 0 && roundOverlaps == 0 && enemyEntries == 0;
+    std::cout << (ok ? "PASS" : "FAIL") << ": " << (ok ? "nothing moved into a wall" : "something moved into a wall") << std::endl;
+    return ok ? 0 : 1;
+}
+
+inline int runBenchmark(const std::string& name) {
+    if (name == "collision") return runCollisionBenchmark();
+    if (name == "enemies") return runEnemyLayoutBenchmark();
+    if (name == "seek") return runSeekBenchmark();
+    if (name == "bullets") return runBulletBenchmark();
+    if (name == "jobs") return runJobsBenchmark();
+    if (name == "flowfield") return runFlowFieldBenchmark();
+    if (name == "culling") return runCullingBenchmark();
+    if (name == "hud") return runHudBenchmark();
+    if (name == "startup") return runStartupBenchmark();
+    if (name == "tunnelling") return runTunnellingBenchmark();
+    if (name == "crowd") return runCrowdBenchmark();
+    if (name == "waves") return runWavesBenchmark();
+    if (name == "ecs") return runEcsBenchmark();
+    if (name == "walls") return runWallsBenchmark();
+
+    std::cout << "Unknown benchmark '" << name << "'. Available: collision, enemies, seek, bullets, jobs, flowfield, culling, hud, startup, tunnelling, crowd, waves, ecs, walls" << std::endl;
+    return 1;
+}
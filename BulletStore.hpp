@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Components.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Bullet storage: the bullet archetype's columns, one array per field.
+// Bullets are only ever moved, so their bounds are worked out from the
+// position with no shape or transform, and they are drawn with one shared
+// circle. Live bullets stay in the order they were fired. The columns are
+// reserved up front for capacity bullets and a shot fired while that many
+// are in flight is dropped, so firing never allocates. A row index is only
+// valid until the next compact(), which renumbers the rows; a bullet that
+// must be found again later is held by its Entity handle.
+class BulletStore : public ArchetypeTable<BulletStore, POSITION_X, POSITION_Y, PREVIOUS_X, PREVIOUS_Y, VELOCITY, BOUNDS> {
+public:
+    std::vector<float> x; // top-left corner of the bullet's circle
+    std::vector<float> y;
+    std::vector<float> previousX; // position before the last update, for interpolation
+    std::vector<float> previousY;
+    std::vector<sf::Vector2f> velocity;
+    std::vector<sf::FloatRect> bounds; // kept in step with the position by spawn() and update()
+
+    static constexpr float radius = 4;
+    long long droppedShots = 0; // shots fired while every bullet was in flight
+
+    explicit BulletStore(int capacity = 1024) {
+        setCapacity(capacity);
+    }
+
+    std::tuple<std::vector<float>&, std::vector<float>&, std::vector<float>&, std::vector<float>&,
+        std::vector<sf::Vector2f>&, std::vector<sf::FloatRect>&> columns() {
+        return std::tie(x, y, previousX, previousY, velocity, bounds);
+    }
+
+    int capacity() const {
+        return maxBullets;
+    }
+
+    void setCapacity(int capacity) {
+        maxBullets = capacity;
+        reserve(capacity);
+    }
+
+    // Launches a bullet centred on (fromX, fromY). Returns its row, or -1
+    // if capacity bullets are already in flight.
+    int spawn(float fromX, float fromY, sf::Vector2f direction, float speed = 600.0f, Entity entity = Entity()) {
+        if (count() >= maxBullets) {
+            droppedShots++;
+            return -1;
+        }
+        int i = addRow(entity);
+        x[i] = fromX - radius;
+        y[i] = fromY - radius;
+        previousX[i] = x[i];
+        previousY[i] = y[i];
+        velocity[i] = direction * speed;
+        updateBounds(i);
+        return i;
+    }
+
+    // Bullets die on the update after leaving the arena, which starts at
+    // (0, 0), so the move that carried them out is still checked for hits
+    void update(float deltaTime, sf::Vector2f arenaSize = sf::Vector2f(1600, 900)) {
+        updateRange(0, count(), deltaTime, arenaSize);
+    }
+
+    // Bullets move independently, so chunks of them can move on any thread
+    void update(float deltaTime, sf::Vector2f arenaSize, JobSystem& jobs) {
+        jobs.parallelFor(count(), 256, [&](int begin, int end) {
+            updateRange(begin, end, deltaTime, arenaSize);
+        });
+    }
+
+    sf::Vector2f getPosition(int i) const {
+        return sf::Vector2f(x[i], y[i]);
+    }
+
+    sf::Vector2f getPreviousPosition(int i) const {
+        return sf::Vector2f(previousX[i], previousY[i]);
+    }
+
+    // Bounds covering the whole of the last move, for the broad-phase
+    sf::FloatRect getSweptBounds(int i) const {
+        sf::Vector2f offset = getPreviousPosition(i) - getPosition(i);
+        const sf::FloatRect& b = bounds[i];
+        float left = std::min(b.left, b.left + offset.x);
+        float top = std::min(b.top, b.top + offset.y);
+        return sf::FloatRect(left, top, b.width + std::abs(offset.x), b.height + std::abs(offset.y));
+    }
+
+private:
+    int maxBullets = 0;
+
+    void updateRange(int begin, int end, float deltaTime, sf::Vector2f arenaSize) {
+        for (int i = begin; i < end; i++) {
+            if (!active[i]) continue;
+            if (x[i] < 0 || x[i] > arenaSize.x || y[i] < 0 || y[i] > arenaSize.y) {
+                active[i] = 0;
+                continue;
+            }
+            previousX[i] = x[i];
+            previousY[i] = y[i];
+            x[i] += velocity[i].x * deltaTime;
+            y[i] += velocity[i].y * deltaTime;
+            updateBounds(i);
+        }
+    }
+
+    // The rect a radius 4 sf::CircleShape at the position would report
+    void updateBounds(int i) {
+        const float diameter = radius * 2;
+        bounds[i] = sf::FloatRect(x[i], y[i], (x[i] + diameter) - x[i], (y[i] + diameter) - y[i]);
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Ecs.hpp"
+#include "Entities.hpp"
+
+// Components of the game's entities (see Ecs.hpp). Positions are split
+// into x and y columns so movement kernels can stream each as an array.
+enum ComponentId {
+    POSITION_X,   // float: top-left corner
+    POSITION_Y,
+    PREVIOUS_X,   // float: position before the last step, for interpolation
+    PREVIOUS_Y,
+    VELOCITY,     // sf::Vector2f, px/s
+    SPEED,        // float: px/s, for entities that steer
+    DAMAGE,       // int: dealt to the player on contact
+    ENEMY_KIND,   // EnemyType
+    PUSH_X,       // float: crowd separation push, kept between recomputes
+    PUSH_Y,
+    BOUNDS,       // sf::FloatRect, kept in step with the position
+    POWERUP_KIND, // PowerupType
+    LIFETIME,     // float: seconds left
+    SCALE,        // float: sprite scale
+    PLAYER        // Player
+};
+
+#define DECLARE_COMPONENT(id, type) \
+    template <> struct ComponentTraits<id> { typedef type Type; }
+
+DECLARE_COMPONENT(POSITION_X, float);
+DECLARE_COMPONENT(POSITION_Y, float);
+DECLARE_COMPONENT(PREVIOUS_X, float);
+DECLARE_COMPONENT(PREVIOUS_Y, float);
+DECLARE_COMPONENT(VELOCITY, sf::Vector2f);
+DECLARE_COMPONENT(SPEED, float);
+DECLARE_COMPONENT(DAMAGE, int);
+DECLARE_COMPONENT(ENEMY_KIND, EnemyType);
+DECLARE_COMPONENT(PUSH_X, float);
+DECLARE_COMPONENT(PUSH_Y, float);
+DECLARE_COMPONENT(BOUNDS, sf::FloatRect);
+DECLARE_COMPONENT(POWERUP_KIND, PowerupType);
+DECLARE_COMPONENT(LIFETIME, float);
+DECLARE_COMPONENT(SCALE, float);
+DECLARE_COMPONENT(PLAYER, Player);
+
+// The player is a single entity whose state is one Player component
+typedef Archetype<PLAYER> PlayerTable;
@@ -0,0 +1,422 @@
+#pragma once
+
+#include <SFML/Config.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A small archetype entity-component system. Each archetype is a table
+// with one dense array (column) per component and one row per entity, so a
+// system touching a few components streams through just those arrays.
+// Components are named by an enum rather than by type, which lets a table
+// hold several columns of the same type (an x and a y of float, say) and
+// hand them to kernels as plain arrays. The game's components and the
+// type each one holds are declared in Components.hpp.
+//
+// Dead rows are only flagged inactive; compact() drops them later, keeping
+// the rest in order, so indices stay valid for the whole tick. A Registry
+// holds one table per archetype and hands out Entity handles that survive
+// compaction and go stale once their entity is gone.
+
+// Handle to an entity in a Registry. A slot's generation goes up each time
+// it is freed, so a handle to a destroyed entity never finds a newer one.
+struct Entity {
+    std::uint32_t index = 0xFFFFFFFFu;
+    std::uint32_t generation = 0;
+
+    bool isNull() const {
+        return index == 0xFFFFFFFFu;
+    }
+
+    bool operator==(const Entity& other) const {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const Entity& other) const {
+        return !(*this == other);
+    }
+};
+
+// The value type of component Id, e.g.
+//     template <> struct ComponentTraits<POSITION_X> { typedef float Type; };
+template <int Id>
+struct ComponentTraits;
+
+template <int Id>
+using ComponentType = typename ComponentTraits<Id>::Type;
+
+// Compile-time lookups over an archetype's component ids
+template <int... Ids>
+struct ComponentList {
+    // Column of Id, or -1 when the archetype does not have it
+    template <int Id>
+    static constexpr int indexOf() {
+        const int ids[] = { Ids... };
+        for (int i = 0; i < static_cast<int>(sizeof...(Ids)); i++) {
+            if (ids[i] == Id) return i;
+        }
+        return -1;
+    }
+
+    template <int... Wanted>
+    static constexpr bool containsAll() {
+        const bool found[] = { (indexOf<Wanted>() >= 0)..., true };
+        for (bool f : found) {
+            if (!f) return false;
+        }
+        return true;
+    }
+};
+
+// Calls visit on every element of a tuple, first to last
+template <typename Tuple, typename Visit, std::size_t... I>
+void forEachInTuple(Tuple&& tuple, Visit& visit, std::index_sequence<I...>) {
+    (void)std::initializer_list<int>{ (visit(std::get<I>(tuple)), 0)... };
+}
+
+template <typename Tuple, typename Visit>
+void forEachInTuple(Tuple&& tuple, Visit visit) {
+    forEachInTuple(tuple, visit, std::make_index_sequence<std::tuple_size<std::decay_t<Tuple>>::value>());
+}
+
+// Rows and columns of one archetype. Derived provides columns(): a tuple of
+// references to its column vectors, in the order of Ids. It can own them
+// as named members, like EnemyStore, or leave that to Archetype below.
+template <typename Derived, int... Ids>
+class ArchetypeTable {
+public:
+    typedef ComponentList<Ids...> Components;
+
+    std::vector<sf::Uint8> active; // not std::vector<bool>: that packs bits
+    std::vector<Entity> entities;  // handle of each row; null for rows added outside a Registry
+
+    int count() const {
+        return static_cast<int>(active.size());
+    }
+
+    template <int Id>
+    std::vector<ComponentType<Id>>& column() {
+        static_assert(Components::template indexOf<Id>() >= 0, "the archetype has no such component");
+        return std::get<Components::template indexOf<Id>()>(self().columns());
+    }
+
+    template <int Id>
+    const std::vector<ComponentType<Id>>& column() const {
+        return const_cast<ArchetypeTable*>(this)->template column<Id>();
+    }
+
+    // Appends a row with every component value-initialised; returns its index
+    int addRow(Entity entity = Entity()) {
+        forEachColumn([](auto& column) { column.emplace_back(); });
+        active.push_back(1);
+        entities.push_back(entity);
+        return count() - 1;
+    }
+
+    void reserve(int capacity) {
+        forEachColumn([capacity](auto& column) { column.reserve(capacity); });
+        active.reserve(capacity);
+        entities.reserve(capacity);
+    }
+
+    void clear() {
+        forEachColumn([](auto& column) { column.clear(); });
+        active.clear();
+        entities.clear();
+    }
+
+    // Calls visit with references to the Wanted components of every live
+    // row, in row order
+    template <int... Wanted, typename Visit>
+    void each(Visit&& visit) {
+        eachRow(visit, column<Wanted>().data()...);
+    }
+
+    template <int... Wanted, typename Visit>
+    void each(Visit&& visit) const {
+        eachRow(visit, column<Wanted>().data()...);
+    }
+
+    // Drops inactive rows, keeping the others in order. moved(entity, row)
+    // is called for each kept row that moved and dropped(entity) for each
+    // row removed, so a Registry can keep its handles pointing at the right
+    // rows. Returns whether any row was dropped, which renumbers the rows
+    // after it.
+    template <typename Moved, typename Dropped>
+    bool compact(Moved moved, Dropped dropped) {
+        const int n = count();
+        int kept = 0;
+        for (int i = 0; i < n; i++) {
+            if (!active[i]) {
+                dropped(entities[i]);
+                continue;
+            }
+            if (kept != i) {
+                entities[kept] = entities[i];
+                moved(entities[kept], kept);
+            }
+            kept++;
+        }
+        if (kept == n) return false;
+
+        forEachColumn([this, n, kept](auto& column) {
+            int k = 0;
+            for (int i = 0; i < n; i++) {
+                if (!active[i]) continue;
+                if (k != i) column[k] = std::move(column[i]);
+                k++;
+            }
+            column.erase(column.begin() + kept, column.end());
+        });
+        entities.erase(entities.begin() + kept, entities.end());
+        active.assign(kept, 1);
+        return true;
+    }
+
+    bool compact() {
+        return compact([](Entity, int) {}, [](Entity) {});
+    }
+
+private:
+    Derived& self() {
+        return static_cast<Derived&>(*this);
+    }
+
+    template <typename Visit>
+    void forEachColumn(Visit visit) {
+        forEachInTuple(self().columns(), visit);
+    }
+
+    template <typename Visit, typename... Column>
+    void eachRow(Visit& visit, Column*... columns) const {
+        const sf::Uint8* alive = active.data();
+        const int n = count();
+        for (int i = 0; i < n; i++) {
+            if (alive[i]) visit(columns[i]...);
+        }
+    }
+};
+
+// An archetype table that owns its columns, for entities with no
+// hand-written store of their own
+template <int... Ids>
+class Archetype : public ArchetypeTable<Archetype<Ids...>, Ids...> {
+public:
+    std::tuple<std::vector<ComponentType<Ids>>&...> columns() {
+        return tieColumns(std::make_index_sequence<sizeof...(Ids)>());
+    }
+
+private:
+    std::tuple<std::vector<ComponentType<Ids>>...> storage;
+
+    template <std::size_t... I>
+    std::tuple<std::vector<ComponentType<Ids>>&...> tieColumns(std::index_sequence<I...>) {
+        return std::tie(std::get<I>(storage)...);
+    }
+};
+
+// Index of T among Ts
+template <typename T, typename... Ts>
+struct TypeIndex;
+
+template <typename T, typename... Rest>
+struct TypeIndex<T, T, Rest...> : std::integral_constant<int, 0> {};
+
+template <typename T, typename First, typename... Rest>
+struct TypeIndex<T, First, Rest...> : std::integral_constant<int, 1 + TypeIndex<T, Rest...>::value> {};
+
+// One table per archetype, and the handles of the entities in them. Rows
+// can also be added to a table directly, without a handle; the registry
+// then just leaves them alone.
+template <typename... Tables>
+class Registry {
+public:
+    template <typename Table>
+    Table& table() {
+        return std::get<TypeIndex<Table, Tables...>::value>(tables);
+    }
+
+    template <typename Table>
+    const Table& table() const {
+        return std::get<TypeIndex<Table, Tables...>::value>(tables);
+    }
+
+    // Makes room for this many live handles without reallocating
+    void reserve(int count) {
+        slots.reserve(count);
+        freeSlots.reserve(count);
+    }
+
+    // Adds a row to Table with every component value-initialised
+    template <typename Table>
+    Entity create() {
+        return add<Table>([this](Entity entity) { return table<Table>().addRow(entity); });
+    }
+
+    // Adds an entity through add(entity), which appends its row to Table
+    // and returns the row, or -1 if it added none. Returns the handle, or a
+    // null one.
+    template <typename Table, typename Add>
+    Entity add(Add add) {
+        Entity entity;
+        if (!freeSlots.empty()) {
+            entity.index = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            entity.index = static_cast<std::uint32_t>(slots.size());
+            slots.push_back(Slot());
+        }
+        entity.generation = slots[entity.index].generation;
+        int row = add(entity);
+        if (row < 0) {
+            release(entity);
+            return Entity();
+        }
+        slots[entity.index].table = TypeIndex<Table, Tables...>::value;
+        slots[entity.index].row = row;
+        return entity;
+    }
+
+    // Flags the entity's row inactive; the next compact() drops it
+    void destroy(Entity entity) {
+        const Slot* slot = find(entity);
+        if (!slot) return;
+        visitTable(slot->table, [slot](auto& table) { table.active[slot->row] = 0; });
+    }
+
+    bool isAlive(Entity entity) const {
+        return rowOf(entity) >= 0;
+    }
+
+    // Row of a live entity in its table, or -1
+    int rowOf(Entity entity) const {
+        const Slot* slot = find(entity);
+        if (!slot) return -1;
+        bool alive = false;
+        visitTable(slot->table, [slot, &alive](const auto& table) { alive = table.active[slot->row] != 0; });
+        return alive ? slot->row : -1;
+    }
+
+    // Component Id of a live entity, or null if it is dead or has no Id
+    template <int Id>
+    ComponentType<Id>* get(Entity entity) {
+        const int row = rowOf(entity);
+        if (row < 0) return nullptr;
+        ComponentType<Id>* component = nullptr;
+        visitTable(slots[entity.index].table, [row, &component](auto& table) {
+            component = componentAt<Id>(table, row, hasComponents<std::decay_t<decltype(table)>, Id>());
+        });
+        return component;
+    }
+
+    // Calls visit with the Wanted components of every live row of every
+    // table that has them all
+    template <int... Wanted, typename Visit>
+    void each(Visit&& visit) {
+        forEachInTuple(tables, [&visit](auto& table) {
+            eachIn<Wanted...>(table, visit, hasComponents<std::decay_t<decltype(table)>, Wanted...>());
+        });
+    }
+
+    // Drops Table's inactive rows and frees their handles. Returns whether
+    // any were dropped.
+    template <typename Table>
+    bool compact() {
+        return table<Table>().compact(
+            [this](Entity entity, int row) {
+                if (!entity.isNull()) slots[entity.index].row = row;
+            },
+            [this](Entity entity) { release(entity); });
+    }
+
+    void compact() {
+        forEachInTuple(tables, [this](auto& table) { this->template compact<std::decay_t<decltype(table)>>(); });
+    }
+
+    // Empties Table, freeing the handles of its rows
+    template <typename Table>
+    void clear() {
+        Table& rows = table<Table>();
+        for (Entity entity : rows.entities) {
+            release(entity);
+        }
+        rows.clear();
+    }
+
+    // Live entities over all tables
+    int liveCount() const {
+        int live = 0;
+        forEachInTuple(tables, [&live](const auto& table) {
+            for (sf::Uint8 alive : table.active) live += alive;
+        });
+        return live;
+    }
+
+private:
+    struct Slot {
+        std::uint32_t generation = 0;
+        int table = -1;
+        int row = -1;
+    };
+
+    std::tuple<Tables...> tables;
+    std::vector<Slot> slots;
+    std::vector<std::uint32_t> freeSlots;
+
+    template <typename Table, int... Wanted>
+    using hasComponents = std::integral_constant<bool, Table::Components::template containsAll<Wanted...>()>;
+
+    const Slot* find(Entity entity) const {
+        if (entity.isNull() || entity.index >= slots.size()) return nullptr;
+        const Slot& slot = slots[entity.index];
+        return slot.generation == entity.generation && slot.table >= 0 ? &slot : nullptr;
+    }
+
+    void release(Entity entity) {
+        if (entity.isNull() || entity.index >= slots.size() || slots[entity.index].generation != entity.generation) return;
+        Slot& slot = slots[entity.index];
+        slot.generation++;
+        slot.table = -1;
+        slot.row = -1;
+        freeSlots.push_back(entity.index);
+    }
+
+    template <typename Visit>
+    void visitTable(int index, Visit visit) {
+        int i = 0;
+        forEachInTuple(tables, [&](auto& table) {
+            if (i++ == index) visit(table);
+        });
+    }
+
+    template <typename Visit>
+    void visitTable(int index, Visit visit) const {
+        int i = 0;
+        forEachInTuple(tables, [&](const auto& table) {
+            if (i++ == index) visit(table);
+        });
+    }
+
+    template <int Id, typename Table>
+    static ComponentType<Id>* componentAt(Table& table, int row, std::true_type) {
+        return &table.template column<Id>()[row];
+    }
+
+    template <int Id, typename Table>
+    static ComponentType<Id>* componentAt(Table&, int, std::false_type) {
+        return nullptr;
+    }
+
+    template <int... Wanted, typename Table, typename Visit>
+    static void eachIn(Table& table, Visit& visit, std::true_type) {
+        table.template each<Wanted...>(visit);
+    }
+
+    template <int... Wanted, typename Table, typename Visit>
+    static void eachIn(Table&, Visit&, std::false_type) {}
+};
@@ -0,0 +1,312 @@
+#pragma once
+
+#include "Components.hpp"
+#include "SeekKernels.hpp"
+#include "JobSystem.hpp"
+#include "FlowField.hpp"
+#include "TileMap.hpp"
+#include "SpatialHash.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Enemy storage. Enemies are kept as parallel arrays rather than one object
+// per enemy holding an sf::Sprite, so the per-tick movement and collision
+// loops only stream through the fields they read. Sprites are built when
+// drawing. The arrays are the component columns of the enemy archetype
+// (see Ecs.hpp), named here so the kernels can take them directly.
+class EnemyStore : public ArchetypeTable<EnemyStore, POSITION_X, POSITION_Y, PREVIOUS_X, PREVIOUS_Y,
+    SPEED, DAMAGE, ENEMY_KIND, PUSH_X, PUSH_Y> {
+public:
+    std::vector<float> x; // sprite position (top-left corner)
+    std::vector<float> y;
+    std::vector<float> previousX; // position before the last step, for interpolation
+    std::vector<float> previousY;
+    std::vector<float> speed;
+    std::vector<int> damage;
+    std::vector<EnemyType> type;
+    std::vector<float> pushX; // separation push per enemy, kept between recomputes
+    std::vector<float> pushY;
+
+    static constexpr float scale = 0.25f; // Increased for visibility
+
+    // Kernel used by update(); lowered automatically if the CPU lacks it
+    SimdLevel simdLevel = bestSimdLevel();
+
+    // Crowd separation (see separate()). Each enemy is pushed away from the
+    // nearest separationNeighbours others whose centres are closer than
+    // separationRadius, harder the closer they are; a radius of 0 turns it
+    // off. Only the first separationCandidates enemies the grid turns up
+    // (its own cell first) are looked at, so a dense crowd costs no more
+    // per enemy than a sparse one, and each enemy's push is only worked out
+    // again every separationInterval ticks, a different share of the horde
+    // each tick.
+    enum { maxSeparationNeighbours = 16 };
+    float separationRadius = 32;
+    int separationNeighbours = 8; // at most maxSeparationNeighbours
+    int separationCandidates = 64;
+    int separationInterval = 4;
+    float separationStrength = 300; // px/s, for a neighbour right on top
+
+    void setArt(const SpriteArt& enemy1, const SpriteArt& enemy2) {
+        art[ENEMY_TYPE_1] = enemy1;
+        art[ENEMY_TYPE_2] = enemy2;
+        for (int t = 0; t < 2; t++) {
+            size[t] = sf::Vector2f(std::abs(art[t].rect.width) * scale, std::abs(art[t].rect.height) * scale);
+        }
+    }
+
+    std::tuple<std::vector<float>&, std::vector<float>&, std::vector<float>&, std::vector<float>&,
+        std::vector<float>&, std::vector<int>&, std::vector<EnemyType>&, std::vector<float>&, std::vector<float>&> columns() {
+        return std::tie(x, y, previousX, previousY, speed, damage, type, pushX, pushY);
+    }
+
+    void clear() {
+        ArchetypeTable::clear();
+        separationTick = 0;
+    }
+
+    // Handle is the entity's in a Registry, or null for a bare store
+    int spawn(float posX, float posY, EnemyType enemyType, std::mt19937& rng, Entity entity = Entity()) {
+        int i = addRow(entity);
+        x[i] = posX;
+        y[i] = posY;
+        type[i] = enemyType;
+        previousX[i] = posX;
+        previousY[i] = posY;
+
+        if (enemyType == ENEMY_TYPE_1) {
+            std::uniform_real_distribution<float> speedDist(80.0f, 120.0f);
+            speed[i] = speedDist(rng);
+            damage[i] = 15;
+        }
+        else {
+            std::uniform_real_distribution<float> speedDist(120.0f, 180.0f);
+            speed[i] = speedDist(rng);
+            damage[i] = 30;
+        }
+        return i;
+    }
+
+    // Moves every live enemy straight towards playerPos in one sweep
+    void update(float deltaTime, sf::Vector2f playerPos) {
+        seekTowards(seekBatch(deltaTime, playerPos), simdLevel);
+    }
+
+    // Same sweep split into chunks across the job system's threads. Each
+    // enemy only depends on itself, so the result is the same bit for bit.
+    void update(float deltaTime, sf::Vector2f playerPos, JobSystem& jobs) {
+        const SeekBatch batch = seekBatch(deltaTime, playerPos);
+        jobs.parallelFor(batch.count, 4096, [&](int begin, int end) {
+            SeekBatch chunk = batch;
+            chunk.x += begin;
+            chunk.y += begin;
+            chunk.speed += begin;
+            chunk.type += begin;
+            chunk.active += begin;
+            chunk.count = end - begin;
+            seekTowards(chunk, simdLevel);
+        });
+    }
+
+    // Moves every live enemy along the flow field towards playerPos, walking
+    // straight at it from the player's own cell or a cell cut off from it
+    void followFlow(float deltaTime, sf::Vector2f playerPos, const FlowField& field) {
+        followFlowRange(0, count(), deltaTime, playerPos, field);
+    }
+
+    void followFlow(float deltaTime, sf::Vector2f playerPos, const FlowField& field, JobSystem& jobs) {
+        jobs.parallelFor(count(), 2048, [&](int begin, int end) {
+            followFlowRange(begin, end, deltaTime, playerPos, field);
+        });
+    }
+
+    // Boids-style separation, so a horde spreads around its target instead
+    // of stacking on one point. Neighbours come from grid, which must hold
+    // the live enemies among [0, n) at their current positions, for some
+    // n <= count(); enemies past n are pushed by the others but push no one
+    // back. Pushes are worked out from the positions before any is
+    // applied, so the result does not depend on how the enemies are split
+    // across threads.
+    void separate(float deltaTime, const SpatialHash& grid, JobSystem& jobs) {
+        if (separationRadius <= 0) return;
+        const int n = count();
+        const int interval = std::max(1, separationInterval);
+        const int phase = separationTick++ % interval;
+
+        // Neighbour centres in the grid's cell order, so the scans below
+        // read them sequentially instead of all over the arrays
+        const int slots = grid.itemCount();
+        slotX.resize(slots);
+        slotY.resize(slots);
+        jobs.parallelFor(slots, 4096, [&](int begin, int end) {
+            for (int slot = begin; slot < end; slot++) {
+                sf::Vector2f center = getCenter(grid.itemAt(slot));
+                slotX[slot] = center.x;
+                slotY[slot] = center.y;
+            }
+        });
+
+        jobs.parallelFor(n, 1024 * interval, [&](int begin, int end) {
+            for (int i = begin + (interval - (begin + phase) % interval) % interval; i < end; i += interval) {
+                separationPush(i, grid, pushX[i], pushY[i]);
+            }
+        });
+        const float scaleBy = separationStrength * deltaTime;
+        jobs.parallelFor(n, 4096, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                x[i] += pushX[i] * scaleBy;
+                y[i] += pushY[i] * scaleBy;
+            }
+        });
+    }
+
+    // Undoes this step's move, one axis at a time, for enemies whose bounds
+    // it took from open ground into a solid tile, so they slide along walls.
+    // Enemies already inside one (spawned there, or a tile appeared) walk
+    // out freely.
+    void blockBy(const TileMap& tiles, JobSystem& jobs) {
+        jobs.parallelFor(count(), 2048, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                if (!active[i]) continue;
+                const sf::Vector2f& s = size[type[i]];
+                if (tiles.overlapsSolid(sf::FloatRect(previousX[i], previousY[i], s.x, s.y))) continue;
+                if (!tiles.overlapsSolid(sf::FloatRect(x[i], y[i], s.x, s.y))) continue;
+                if (!tiles.overlapsSolid(sf::FloatRect(x[i], previousY[i], s.x, s.y))) {
+                    y[i] = previousY[i];
+                }
+                else if (!tiles.overlapsSolid(sf::FloatRect(previousX[i], y[i], s.x, s.y))) {
+                    x[i] = previousX[i];
+                }
+                else {
+                    x[i] = previousX[i];
+                    y[i] = previousY[i];
+                }
+            }
+        });
+    }
+
+    sf::Vector2f getCenter(int i) const {
+        const sf::Vector2f& s = size[type[i]];
+        return sf::Vector2f(x[i] + s.x / 2, y[i] + s.y / 2);
+    }
+
+    sf::FloatRect getBounds(int i) const {
+        const sf::Vector2f& s = size[type[i]];
+        return sf::FloatRect(x[i], y[i], s.x, s.y);
+    }
+
+    const SpriteArt& getArt(int i) const {
+        return art[type[i]];
+    }
+
+    // Same transform applyToSprite() would give the sprite
+    sf::Transform getTransform(int i) const {
+        sf::Transform transform;
+        transform.translate(x[i], y[i]).scale(scale, scale);
+        return transform;
+    }
+
+    // Transform at alpha of the way from the previous to the current step
+    sf::Transform getTransform(int i, float alpha) const {
+        sf::Transform transform;
+        transform.translate(previousX[i] + (x[i] - previousX[i]) * alpha, previousY[i] + (y[i] - previousY[i]) * alpha).scale(scale, scale);
+        return transform;
+    }
+
+    // Points a reusable sprite at enemy i so it can be drawn
+    void applyToSprite(int i, sf::Sprite& sprite) const {
+        art[type[i]].applyTo(sprite);
+        sprite.setScale(scale, scale);
+        sprite.setPosition(x[i], y[i]);
+    }
+
+private:
+    SpriteArt art[2];
+    sf::Vector2f size[2]; // scaled sprite size per enemy type
+    std::vector<float> slotX; // neighbour centres in grid cell order
+    std::vector<float> slotY;
+    int separationTick = 0;
+
+    SeekBatch seekBatch(float deltaTime, sf::Vector2f playerPos) {
+        SeekBatch batch;
+        batch.x = x.data();
+        batch.y = y.data();
+        batch.speed = speed.data();
+        batch.type = type.data();
+        batch.active = active.data();
+        batch.count = count();
+        for (int t = 0; t < 2; t++) {
+            batch.halfWidth[t] = size[t].x / 2.0f;
+            batch.halfHeight[t] = size[t].y / 2.0f;
+        }
+        batch.targetX = playerPos.x;
+        batch.targetY = playerPos.y;
+        batch.deltaTime = deltaTime;
+        return batch;
+    }
+
+    // Direction and strength (up to 1 per neighbour) enemy i is pushed
+    // away from its nearest neighbours within separationRadius, reading
+    // their centres from the copy separate() made. Enemies on exactly the
+    // same spot are split apart by index.
+    void separationPush(int i, const SpatialHash& grid, float& outX, float& outY) const {
+        outX = 0;
+        outY = 0;
+        if (!active[i]) return;
+        const sf::Vector2f center = getCenter(i);
+        const float radius = separationRadius;
+        const int cap = std::max(0, std::min(separationNeighbours, static_cast<int>(maxSeparationNeighbours)));
+
+        // The nearest neighbours so far; once full, a closer one replaces the farthest
+        float nearX[maxSeparationNeighbours], nearY[maxSeparationNeighbours], nearSquared[maxSeparationNeighbours];
+        int found = 0, farthest = 0, candidates = 0;
+        grid.queryNear(center, radius, [&](int j, int slot) {
+            if (j == i) return true;
+            if (++candidates > separationCandidates) return false;
+            float dx = center.x - slotX[slot];
+            float dy = center.y - slotY[slot];
+            float squared = dx * dx + dy * dy;
+            if (squared >= radius * radius) return true;
+            if (squared == 0) dx = (i < j) ? -radius : radius;
+            int kept = found;
+            if (found < cap) found++;
+            else if (cap > 0 && squared < nearSquared[farthest]) kept = farthest;
+            else return true;
+            nearX[kept] = dx;
+            nearY[kept] = dy;
+            nearSquared[kept] = squared;
+            if (found == cap) {
+                farthest = 0;
+                for (int k = 1; k < found; k++) {
+                    if (nearSquared[k] > nearSquared[farthest]) farthest = k;
+                }
+            }
+            return true;
+        });
+
+        for (int k = 0; k < found; k++) {
+            if (nearSquared[k] == 0) {
+                outX += nearX[k] / radius;
+                continue;
+            }
+            float length = std::sqrt(nearSquared[k]);
+            float weight = (1 - length / radius) / length;
+            outX += nearX[k] * weight;
+            outY += nearY[k] * weight;
+        }
+    }
+
+    void followFlowRange(int begin, int end, float deltaTime, sf::Vector2f playerPos, const FlowField& field) {
+        for (int i = begin; i < end; i++) {
+            if (!active[i]) continue;
+            sf::Vector2f center = getCenter(i);
+            sf::Vector2f direction = field.sample(center);
+            if (direction.x == 0 && direction.y == 0) {
+                direction = normalize(playerPos - center);
+            }
+            x[i] += direction.x * speed[i] * deltaTime;
+            y[i] += direction.y * speed[i] * deltaTime;
+        }
+    }
+};
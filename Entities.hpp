@@ -0,0 +1,233 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+// Game states
+enum GameState {
+    MAIN_MENU,
+    PLAYING_CLASSIC,
+    PLAYING_TIME_TRIAL,
+    GAME_OVER,
+    VICTORY,
+    TIME_TRIAL_RESULTS
+};
+
+// Powerup types
+enum PowerupType {
+    HEALTH_BOOST,
+    SPEED_BOOST
+};
+
+// Enemy types
+enum EnemyType {
+    ENEMY_TYPE_1,
+    ENEMY_TYPE_2
+};
+
+// Texture rect a sprite is built from. The texture may be null when running
+// headless: the sprite then only carries its size, which is all the
+// simulation needs for bounds and collision.
+struct SpriteArt {
+    const sf::Texture* texture = nullptr;
+    sf::IntRect rect;
+
+    void applyTo(sf::Sprite& sprite) const {
+        if (texture) sprite.setTexture(*texture);
+        sprite.setTextureRect(rect);
+    }
+};
+
+// Art for every simulated entity kind
+struct GameArt {
+    SpriteArt player;
+    SpriteArt enemy1;
+    SpriteArt enemy2;
+    SpriteArt health;
+    SpriteArt speed;
+    SpriteArt floor;
+    SpriteArt wall;
+    SpriteArt destructible;
+};
+
+// Utility functions
+inline sf::Vector2f lerp(sf::Vector2f from, sf::Vector2f to, float alpha) {
+    return from + (to - from) * alpha;
+}
+
+inline float distance(sf::Vector2f a, sf::Vector2f b) {
+    return sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+}
+
+inline sf::Vector2f normalize(sf::Vector2f vector) {
+    float length = sqrt(vector.x * vector.x + vector.y * vector.y);
+    if (length > 0) {
+        return sf::Vector2f(vector.x / length, vector.y / length);
+    }
+    return sf::Vector2f(0, 0);
+}
+
+inline bool checkCollision(const sf::FloatRect& a, const sf::FloatRect& b) {
+    return a.intersects(b);
+}
+
+// Earliest fraction of the move from `from` to `to`, in [0, 1], at which a
+// box of the given half-size centred on the moving point overlaps target,
+// or -1 if it never does. The segment is clipped against target grown by
+// the half-size (a slab test), so a box that moves further than its own
+// size in one step still cannot skip over target.
+inline float sweepCollision(sf::Vector2f from, sf::Vector2f to, sf::Vector2f halfSize, const sf::FloatRect& target) {
+    const float start[2] = { from.x, from.y };
+    const float delta[2] = { to.x - from.x, to.y - from.y };
+    const float low[2] = { target.left - halfSize.x, target.top - halfSize.y };
+    const float high[2] = { target.left + target.width + halfSize.x, target.top + target.height + halfSize.y };
+    float enter = 0, exit = 1;
+    for (int axis = 0; axis < 2; axis++) {
+        if (delta[axis] == 0) {
+            // Touching edges do not count, as with FloatRect::intersects
+            if (start[axis] <= low[axis] || start[axis] >= high[axis]) return -1;
+            continue;
+        }
+        float t0 = (low[axis] - start[axis]) / delta[axis];
+        float t1 = (high[axis] - start[axis]) / delta[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        if (enter >= exit) return -1;
+    }
+    return enter;
+}
+
+// Collision shape of an entity for the current tick. It is worked out from
+// the sprite's transform once, after the entity moves, and then read by
+// every collision pass instead of calling getGlobalBounds() each time.
+struct CollisionProxy {
+    sf::FloatRect bounds;
+    sf::Vector2f center;
+    sf::Vector2f halfSize;
+
+    void set(const sf::FloatRect& newBounds) {
+        bounds = newBounds;
+        halfSize = sf::Vector2f(bounds.width / 2, bounds.height / 2);
+        center = sf::Vector2f(bounds.left + halfSize.x, bounds.top + halfSize.y);
+    }
+};
+
+// Player class
+class Player {
+public:
+    sf::Sprite sprite;
+    float speed;
+    float baseSpeed;
+    int health;
+    int maxHealth;
+    float speedBoostTimer;
+    bool hasSpeedBoost;
+    sf::Vector2f previousPosition; // position before the last step, for interpolation
+    CollisionProxy proxy; // as of the last refreshProxy(); the World refreshes it after moving the sprite
+
+    Player() : Player(0, 0, SpriteArt()) {}
+
+    // (x, y) is where the middle of the sprite goes: it turns about its centre
+    Player(float x, float y, const SpriteArt& art) {
+        art.applyTo(sprite);
+        sprite.setOrigin(std::abs(art.rect.width) / 2.0f, std::abs(art.rect.height) / 2.0f);
+        sprite.setPosition(x, y);
+        previousPosition = sprite.getPosition();
+        sprite.setScale(0.4f, 0.4f); // Increased for visibility
+        refreshProxy();
+
+        baseSpeed = 300.0f;
+        speed = baseSpeed;
+        health = 100;
+        maxHealth = 100;
+        speedBoostTimer = 0;
+        hasSpeedBoost = false;
+    }
+
+    void reset(float x, float y) {
+        sprite.setPosition(x, y);
+        sprite.setRotation(0);
+        previousPosition = sprite.getPosition();
+        refreshProxy();
+        health = 100;
+        speed = baseSpeed;
+        speedBoostTimer = 0;
+        hasSpeedBoost = false;
+    }
+
+    void update(float deltaTime) {
+        if (hasSpeedBoost) {
+            speedBoostTimer -= deltaTime;
+            if (speedBoostTimer <= 0) {
+                hasSpeedBoost = false;
+                speed = baseSpeed;
+            }
+        }
+    }
+
+    void takeDamage(int damage) {
+        health -= damage;
+        if (health < 0) health = 0;
+    }
+
+    void heal(int amount) {
+        health += amount;
+        if (health > maxHealth) health = maxHealth;
+    }
+
+    void applySpeedBoost() {
+        hasSpeedBoost = true;
+        speed = baseSpeed * 1.5f;
+        speedBoostTimer = 5.0f;
+    }
+
+    sf::Vector2f getCenter() const {
+        sf::FloatRect bounds = sprite.getGlobalBounds();
+        return sf::Vector2f(bounds.left + bounds.width / 2, bounds.top + bounds.height / 2);
+    }
+
+    sf::FloatRect getBounds() const {
+        return sprite.getGlobalBounds();
+    }
+
+    void refreshProxy() {
+        proxy.set(sprite.getGlobalBounds());
+    }
+
+    // Square over the middle of the body, as wide as the body is across its
+    // short side, used against walls. The sprite turns about its centre, so
+    // the square does not change as it turns and turning never pushes it
+    // into a wall.
+    sf::FloatRect getFootprint() const {
+        sf::FloatRect local = sprite.getLocalBounds();
+        sf::Vector2f scale = sprite.getScale();
+        float side = std::min(local.width * std::abs(scale.x), local.height * std::abs(scale.y));
+        sf::Vector2f pos = sprite.getPosition();
+        return sf::FloatRect(pos.x - side / 2, pos.y - side / 2, side, side);
+    }
+
+    // Turns from the proxy's center, so refresh it first after a move.
+    // Returns whether the sprite turned, which makes the proxy stale.
+    bool rotateTowards(sf::Vector2f targetPos) {
+        sf::Vector2f playerCenter = proxy.center;
+        sf::Vector2f direction = targetPos - playerCenter;
+
+        // Calculate distance to mouse
+        float distance = sqrt(direction.x * direction.x + direction.y * direction.y);
+
+        // Only rotate if mouse is far enough away (dead zone)
+        if (distance > 30.0f) {  // 30 pixel dead zone - adjust this value as needed
+            // Calculate angle in degrees
+            float angle = atan2(direction.y, direction.x) * 180.0f / 3.14159f;
+
+            // Set the rotation
+            sprite.setRotation(angle);
+            return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cmath>
+
+// Turns variable frame times into a whole number of fixed simulation steps.
+// Leftover time carries over to the next frame, and alpha() says how far
+// the render is between the last two simulated states.
+//
+//     timestep.addFrameTime(frameSeconds);
+//     while (timestep.consumeStep()) world.step(timestep.step, ...);
+//     render(timestep.alpha());
+//
+// At most maxStepsPerFrame steps run per frame. If a slow frame leaves more
+// than that owed, the backlog is dropped (the game briefly runs slower)
+// instead of making the next frame slower still.
+class FixedTimestep {
+public:
+    float step;
+    int maxStepsPerFrame;
+    long long droppedSteps = 0; // steps skipped to stay out of the spiral of death
+
+    explicit FixedTimestep(float stepSeconds = 1.0f / 120.0f, int maxSteps = 8)
+        : step(stepSeconds), maxStepsPerFrame(maxSteps) {
+    }
+
+    void addFrameTime(float frameSeconds) {
+        accumulator += frameSeconds;
+        stepsThisFrame = 0;
+    }
+
+    bool consumeStep() {
+        if (accumulator < step) return false;
+        if (stepsThisFrame == maxStepsPerFrame) {
+            droppedSteps += static_cast<long long>(accumulator / step);
+            accumulator = std::fmod(accumulator, step);
+            return false;
+        }
+        accumulator -= step;
+        stepsThisFrame++;
+        return true;
+    }
+
+    // Fraction of a step between the previous and the current state
+    float alpha() const {
+        return accumulator / step;
+    }
+
+    void reset() {
+        accumulator = 0;
+        stepsThisFrame = 0;
+    }
+
+private:
+    float accumulator = 0;
+    int stepsThisFrame = 0;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <SFML/Config.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Grid of directions leading every open cell towards one target cell around
+// obstacles, so any number of enemies can path to the player by reading the
+// cell they stand in. The field is a breadth-first distance from the target
+// cell; each cell then points at its closest neighbour (diagonals included,
+// but never across a blocked corner).
+//
+// update() only rebuilds when the target has moved to another cell or a cell
+// was blocked or cleared since the last build. Buffers are sized once, so
+// rebuilding does not allocate.
+class FlowField {
+public:
+    int rebuilds = 0; // number of times the field was recomputed
+
+    FlowField(float width = 1600, float height = 900, float cellSize = 32) {
+        resize(width, height, cellSize);
+    }
+
+    void resize(float width, float height, float newCellSize) {
+        cellSize = newCellSize;
+        columns = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+        rows = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+        blocked.assign(columns * rows, 0);
+        distance.assign(columns * rows, unreachable);
+        directionX.assign(columns * rows, 0.0f);
+        directionY.assign(columns * rows, 0.0f);
+        frontier.assign(columns * rows, 0);
+        blockedCount = 0;
+        targetCell = -1;
+        dirty = true;
+    }
+
+    int columnCount() const { return columns; }
+    int rowCount() const { return rows; }
+    float getCellSize() const { return cellSize; }
+
+    void setBlocked(int column, int row, bool isBlocked) {
+        if (column < 0 || column >= columns || row < 0 || row >= rows) return;
+        sf::Uint8& cell = blocked[cellIndex(column, row)];
+        if ((cell != 0) == isBlocked) return;
+        cell = isBlocked ? 1 : 0;
+        blockedCount += isBlocked ? 1 : -1;
+        dirty = true;
+    }
+
+    bool isBlocked(int column, int row) const {
+        return blocked[cellIndex(column, row)] != 0;
+    }
+
+    // With nothing in the way the field only approximates a straight line,
+    // so callers can keep seeking directly until something is blocked
+    bool hasObstacles() const {
+        return blockedCount > 0;
+    }
+
+    // Rebuilds the field towards target if needed; returns whether it did
+    bool update(sf::Vector2f target) {
+        int cell = cellAt(target);
+        if (cell == targetCell && !dirty) return false;
+        targetCell = cell;
+        dirty = false;
+        rebuild();
+        rebuilds++;
+        return true;
+    }
+
+    // Unit direction to walk from position, or (0, 0) in the target's own
+    // cell and in cells with no way to it, where walking straight at the
+    // target is the best there is
+    sf::Vector2f sample(sf::Vector2f position) const {
+        int cell = cellAt(position);
+        return sf::Vector2f(directionX[cell], directionY[cell]);
+    }
+
+    // Steps from the cell to the target cell, or -1 if it cannot get there
+    int stepsToTarget(sf::Vector2f position) const {
+        int steps = distance[cellAt(position)];
+        return steps == unreachable ? -1 : steps;
+    }
+
+private:
+    enum { unreachable = 0x7fffffff };
+
+    float cellSize = 32;
+    int columns = 1;
+    int rows = 1;
+    int blockedCount = 0;
+    int targetCell = -1;
+    bool dirty = true;
+
+    std::vector<sf::Uint8> blocked;
+    std::vector<int> distance;
+    std::vector<float> directionX;
+    std::vector<float> directionY;
+    std::vector<int> frontier; // BFS queue, one slot per cell
+
+    // Positions outside the arena are clamped into the border cells
+    int cellAt(sf::Vector2f position) const {
+        int column = std::max(0, std::min(columns - 1, static_cast<int>(std::floor(position.x / cellSize))));
+        int row = std::max(0, std::min(rows - 1, static_cast<int>(std::floor(position.y / cellSize))));
+        return cellIndex(column, row);
+    }
+
+    int cellIndex(int column, int row) const {
+        return row * columns + column;
+    }
+
+    bool open(int column, int row) const {
+        return column >= 0 && column < columns && row >= 0 && row < rows && !blocked[cellIndex(column, row)];
+    }
+
+    void rebuild() {
+        std::fill(distance.begin(), distance.end(), unreachable);
+        std::fill(directionX.begin(), directionX.end(), 0.0f);
+        std::fill(directionY.begin(), directionY.end(), 0.0f);
+
+        int head = 0, tail = 0;
+        distance[targetCell] = 0;
+        frontier[tail++] = targetCell;
+        while (head < tail) {
+            int cell = frontier[head++];
+            int column = cell % columns;
+            int row = cell / columns;
+            const int offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+            for (const auto& offset : offsets) {
+                int nextColumn = column + offset[0];
+                int nextRow = row + offset[1];
+                if (!open(nextColumn, nextRow)) continue;
+                int next = cellIndex(nextColumn, nextRow);
+                if (distance[next] != unreachable) continue;
+                distance[next] = distance[cell] + 1;
+                frontier[tail++] = next;
+            }
+        }
+
+        const float diagonal = 0.70710678f;
+        for (int row = 0; row < rows; row++) {
+            for (int column = 0; column < columns; column++) {
+                int cell = cellIndex(column, row);
+                if (distance[cell] == unreachable || cell == targetCell) continue;
+                int best = distance[cell];
+                int bestX = 0, bestY = 0;
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        if ((dx == 0 && dy == 0) || !open(column + dx, row + dy)) continue;
+                        if (dx != 0 && dy != 0 && (!open(column + dx, row) || !open(column, row + dy))) continue;
+                        int d = distance[cellIndex(column + dx, row + dy)];
+                        if (d < best) {
+                            best = d;
+                            bestX = dx;
+                            bestY = dy;
+                        }
+                    }
+                }
+                float scale = (bestX != 0 && bestY != 0) ? diagonal : 1.0f;
+                directionX[cell] = bestX * scale;
+                directionY[cell] = bestY * scale;
+            }
+        }
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <cstdio>
+
+// sf::Text for a HUD value that changes now and then. It remembers what it
+// last showed and only formats the string (into a stack buffer) and calls
+// setString, which makes SFML lay the glyphs out again, when the value
+// actually changes. On most frames showing a value is a compare.
+class HudText {
+public:
+    sf::Text text;
+    int relayouts = 0; // setString calls so far
+
+    // format takes one int, e.g. "Kills: %d"
+    void show(const char* format, int value) {
+        show(format, value, 0);
+    }
+
+    // format takes two ints, e.g. "Kills: %d/%d"; formats are told apart
+    // by address, so pass string literals
+    void show(const char* format, int first, int second) {
+        if (format == lastFormat && first == lastFirst && second == lastSecond) return;
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), format, first, second);
+        update(format, first, second, buffer);
+    }
+
+    // Seconds to a tenth, e.g. "Time: %.1f"; only a new tenth re-lays out
+    void showTenths(const char* format, float seconds) {
+        int tenths = static_cast<int>(std::lround(seconds * 10.0f));
+        if (format == lastFormat && tenths == lastFirst) return;
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), format, tenths / 10.0);
+        update(format, tenths, 0, buffer);
+    }
+
+    void hide() {
+        if (lastFormat == nullptr) return;
+        update(nullptr, 0, 0, "");
+    }
+
+    bool isHidden() const {
+        return lastFormat == nullptr;
+    }
+
+private:
+    const char* lastFormat = nullptr; // null while nothing is shown
+    int lastFirst = 0;
+    int lastSecond = 0;
+
+    void update(const char* format, int first, int second, const char* shown) {
+        lastFormat = format;
+        lastFirst = first;
+        lastSecond = second;
+        text.setString(shown);
+        relayouts++;
+    }
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool for splitting per-tick loops across cores.
+//
+//     jobs.parallelFor(count, 1024, [&](int begin, int end) {
+//         for (int i = begin; i < end; i++) ...
+//     });
+//
+// parallelFor cuts [0, count) into chunks, deals them round-robin onto one
+// queue per thread and returns once every chunk has run. The calling
+// thread works through chunks too. A thread takes work from the back of
+// its own queue and, when that is empty, steals from the front of the
+// others, so an uneven split still keeps every core busy.
+//
+// Chunks run in no particular order, so the body must only write state
+// that belongs to its own range; anything order-dependent is merged by the
+// caller afterwards. Bodies must not call parallelFor themselves. Queues
+// are fixed-size arrays, so scheduling never allocates.
+class JobSystem {
+public:
+    static const int maxThreads = 64;
+
+    // Shared pool sized to the machine, capped at 8 threads
+    static JobSystem& shared() {
+        static JobSystem jobs(std::min(8, std::max(1, static_cast<int>(std::thread::hardware_concurrency()))));
+        return jobs;
+    }
+
+    // threadCount includes the thread calling parallelFor; 1 runs
+    // everything inline
+    explicit JobSystem(int threadCount) : queues(std::max(1, std::min(threadCount, static_cast<int>(maxThreads)))) {
+        for (int i = 1; i < static_cast<int>(queues.size()); i++) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int threadCount() const {
+        return static_cast<int>(queues.size());
+    }
+
+    // Runs body(begin, end) over chunks of [0, count), each at least
+    // minChunk long except possibly the last, and waits for all of them
+    template <typename Body>
+    void parallelFor(int count, int minChunk, const Body& body) {
+        if (count <= 0) return;
+        int chunks = std::min(threadCount() * chunksPerThread, (count + minChunk - 1) / std::max(minChunk, 1));
+        if (chunks <= 1) {
+            body(0, count);
+            return;
+        }
+
+        int chunkSize = (count + chunks - 1) / chunks;
+        std::atomic<int> pending((count + chunkSize - 1) / chunkSize);
+        int queue = 0;
+        for (int begin = 0; begin < count; begin += chunkSize) {
+            Job job;
+            job.run = &invoke<Body>;
+            job.body = &body;
+            job.begin = begin;
+            job.end = std::min(begin + chunkSize, count);
+            job.pending = &pending;
+            queues[queue].push(job);
+            queue = (queue + 1) % threadCount();
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            generation++;
+        }
+        wake.notify_all();
+
+        Job job;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (takeJob(0, job)) {
+                runJob(job);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    static const int chunksPerThread = 4;
+    static const int queueCapacity = 64;
+
+    struct Job {
+        void (*run)(const void* body, int begin, int end);
+        const void* body;
+        int begin;
+        int end;
+        std::atomic<int>* pending;
+    };
+
+    // Fixed-size deque; the owner pops from the back, thieves from the front
+    struct WorkQueue {
+        std::mutex mutex;
+        Job jobs[queueCapacity];
+        int head = 0;
+        int tail = 0;
+
+        void push(const Job& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            assert(tail - head < queueCapacity);
+            jobs[tail % queueCapacity] = job;
+            tail++;
+        }
+
+        bool popBack(Job& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head == tail) return false;
+            tail--;
+            job = jobs[tail % queueCapacity];
+            if (head == tail) head = tail = 0;
+            return true;
+        }
+
+        bool popFront(Job& job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head == tail) return false;
+            job = jobs[head % queueCapacity];
+            head++;
+            if (head == tail) head = tail = 0;
+            return true;
+        }
+    };
+
+    std::vector<WorkQueue> queues;
+    std::vector<std::thread> workers;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    unsigned generation = 0;
+    bool stopping = false;
+
+    template <typename Body>
+    static void invoke(const void* body, int begin, int end) {
+        (*static_cast<const Body*>(body))(begin, end);
+    }
+
+    static void runJob(const Job& job) {
+        job.run(job.body, job.begin, job.end);
+        job.pending->fetch_sub(1, std::memory_order_release);
+    }
+
+    bool takeJob(int self, Job& job) {
+        if (queues[self].popBack(job)) return true;
+        for (int offset = 1; offset < threadCount(); offset++) {
+            if (queues[(self + offset) % threadCount()].popFront(job)) return true;
+        }
+        return false;
+    }
+
+    void workerLoop(int self) {
+        unsigned seen = 0;
+        Job job;
+        for (;;) {
+            if (takeJob(self, job)) {
+                runJob(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+    }
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// Leveled logging that never blocks the game loop. Callers format into a
+// slot of a fixed-size lock-free ring buffer and a background thread writes
+// the slots to stdout. When the ring is full, messages are dropped and
+// counted rather than waited on.
+//
+// Levels below LOG_MIN_LEVEL are removed at compile time, arguments and
+// all. Everything else is filtered at runtime by level and by category, and
+// a disabled message costs one branch: its arguments are not evaluated.
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_TRACE
+#endif
+
+// Log categories, combined as a bit mask
+enum LogCategory {
+    LOG_GENERAL = 1 << 0, // startup, assets, warnings
+    LOG_RENDER = 1 << 1,  // per-entity draw trace
+    LOG_FRAME = 1 << 2    // per-frame summary
+};
+
+class Logger {
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    bool enabled(int level, int category) const {
+        return level >= minLevel.load(std::memory_order_relaxed)
+            && (categories.load(std::memory_order_relaxed) & category) != 0;
+    }
+
+    void setLevel(int level) {
+        minLevel.store(level, std::memory_order_relaxed);
+    }
+
+    void enableCategories(int mask) {
+        categories.fetch_or(mask, std::memory_order_relaxed);
+    }
+
+    // Enables categories from a comma-separated list such as "render,frame"
+    // and lowers the level so their trace messages show. Returns false if a
+    // name is not recognised.
+    bool enableTrace(const std::string& list) {
+        bool ok = true;
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t end = list.find(',', start);
+            if (end == std::string::npos) end = list.size();
+            std::string name = list.substr(start, end - start);
+            if (name == "render") enableCategories(LOG_RENDER);
+            else if (name == "frame") enableCategories(LOG_FRAME);
+            else if (name == "all") enableCategories(LOG_GENERAL | LOG_RENDER | LOG_FRAME);
+            else ok = false;
+            start = end + 1;
+        }
+        setLevel(LOG_LEVEL_TRACE);
+        return ok;
+    }
+
+    void write(int level, const char* format, ...) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[pos & (capacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        va_list args;
+        va_start(args, format);
+        std::vsnprintf(slot->text, sizeof(slot->text), format, args);
+        va_end(args);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        startWriter();
+    }
+
+    size_t droppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    ~Logger() {
+        running.store(false);
+        if (writer.joinable()) writer.join();
+        drain();
+    }
+
+private:
+    static const size_t capacity = 8192; // power of two
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        int level;
+        char text[120];
+    };
+
+    Slot slots[capacity];
+    std::atomic<size_t> tail{ 0 };
+    size_t head = 0; // only touched by the writer thread
+    std::atomic<int> minLevel{ LOG_LEVEL_INFO };
+    std::atomic<int> categories{ LOG_GENERAL };
+    std::atomic<size_t> dropped{ 0 };
+    size_t droppedReported = 0;
+    std::atomic<bool> running{ true };
+    std::atomic<bool> writerStarted{ false };
+    std::thread writer;
+
+    Logger() {
+        for (size_t i = 0; i < capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // The writer thread is only started once something is logged
+    void startWriter() {
+        if (writerStarted.load(std::memory_order_relaxed)) return;
+        if (writerStarted.exchange(true)) return;
+        writer = std::thread([this] {
+            while (running.load()) {
+                if (!drain()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                }
+            }
+        });
+    }
+
+    static const char* levelName(int level) {
+        switch (level) {
+        case LOG_LEVEL_TRACE: return "TRACE";
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        case LOG_LEVEL_INFO: return "INFO";
+        case LOG_LEVEL_WARN: return "WARN";
+        default: return "ERROR";
+        }
+    }
+
+    // Writes every published message; returns whether there were any
+    bool drain() {
+        bool wrote = false;
+        for (;;) {
+            Slot& slot = slots[head & (capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;
+            std::fprintf(stdout, "[%s] %s\n", levelName(slot.level), slot.text);
+            slot.sequence.store(head + capacity, std::memory_order_release);
+            head++;
+            wrote = true;
+        }
+
+        size_t droppedNow = dropped.load(std::memory_order_relaxed);
+        if (droppedNow != droppedReported) {
+            std::fprintf(stdout, "[WARN] log buffer full, %zu messages dropped\n", droppedNow - droppedReported);
+            droppedReported = droppedNow;
+            wrote = true;
+        }
+
+        if (wrote) std::fflush(stdout);
+        return wrote;
+    }
+};
+
+#define LOG_AT(level, category, ...) \
+    do { \
+        if ((level) >= LOG_MIN_LEVEL && Logger::instance().enabled((level), (category))) \
+            Logger::instance().write((level), __VA_ARGS__); \
+    } while (0)
+
+#define LOG_TRACE(category, ...) LOG_AT(LOG_LEVEL_TRACE, category, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, LOG_GENERAL, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, LOG_GENERAL, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, LOG_GENERAL, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, LOG_GENERAL, __VA_ARGS__)
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Components.hpp"
+#include <cmath>
+#include <vector>
+
+// Powerup storage: the powerup archetype's columns. A powerup is a sprite
+// that pulses in size until its lifetime runs out; its bounds are worked
+// out from the position and scale when update() rescales it, and sprites
+// are only built when drawing.
+class PowerupStore : public ArchetypeTable<PowerupStore, POSITION_X, POSITION_Y, POWERUP_KIND, LIFETIME, SCALE, BOUNDS> {
+public:
+    std::vector<float> x; // sprite position (top-left corner)
+    std::vector<float> y;
+    std::vector<PowerupType> type;
+    std::vector<float> lifetime; // seconds left
+    std::vector<float> scale;
+    std::vector<sf::FloatRect> bounds; // kept in step with the scale by spawn() and update()
+
+    std::tuple<std::vector<float>&, std::vector<float>&, std::vector<PowerupType>&, std::vector<float>&,
+        std::vector<float>&, std::vector<sf::FloatRect>&> columns() {
+        return std::tie(x, y, type, lifetime, scale, bounds);
+    }
+
+    void setArt(const SpriteArt& health, const SpriteArt& speed) {
+        art[HEALTH_BOOST] = health;
+        art[SPEED_BOOST] = speed;
+    }
+
+    int spawn(float posX, float posY, PowerupType powerupType, Entity entity = Entity()) {
+        int i = addRow(entity);
+        x[i] = posX;
+        y[i] = posY;
+        type[i] = powerupType;
+        lifetime[i] = 10.0f;
+        scale[i] = 0.1f; // Increased for visibility
+        updateBounds(i);
+        return i;
+    }
+
+    void update(float deltaTime) {
+        const int n = count();
+        for (int i = 0; i < n; i++) {
+            if (!active[i]) continue;
+            lifetime[i] -= deltaTime;
+            if (lifetime[i] <= 0) {
+                active[i] = 0;
+            }
+            float pulse = sin(lifetime[i] * 5) * 0.02f + 1.0f;
+            scale[i] = 0.12f * pulse;
+            updateBounds(i);
+        }
+    }
+
+    const SpriteArt& getArt(int i) const {
+        return art[type[i]];
+    }
+
+    // Same transform a sprite at the powerup's position and scale would have
+    sf::Transform getTransform(int i) const {
+        sf::Transform transform;
+        transform.translate(x[i], y[i]).scale(scale[i], scale[i]);
+        return transform;
+    }
+
+private:
+    SpriteArt art[2];
+
+    // The rect sprite.getGlobalBounds() would give, without building the
+    // transform: powerups are never turned
+    void updateBounds(int i) {
+        const sf::IntRect& rect = art[type[i]].rect;
+        float right = x[i] + scale[i] * std::abs(rect.width);
+        float bottom = y[i] + scale[i] * std::abs(rect.height);
+        bounds[i] = sf::FloatRect(x[i], y[i], right - x[i], bottom - y[i]);
+    }
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Per-phase frame timing. PROFILE_SCOPE(phase) times the rest of the
+// enclosing block and adds it to that phase's total for the current frame;
+// a phase may be entered several times per frame (the simulation runs
+// several steps), and the times add up. endFrame() stores the totals in a
+// rolling history that the percentiles are taken from.
+//
+// Only the main thread may record timings.
+
+enum ProfilePhase {
+    PROFILE_EVENTS,
+    PROFILE_MOVEMENT,
+    PROFILE_SPAWNING,
+    PROFILE_COLLISION,
+    PROFILE_COMPACTION,
+    PROFILE_HUD,
+    PROFILE_DRAW,
+    PROFILE_PRESENT, // display(), including the wait for the frame limit
+    PROFILE_FRAME,   // whole frame, from one endFrame() to the next
+    PROFILE_PHASE_COUNT
+};
+
+inline const char* profilePhaseName(int phase) {
+    switch (phase) {
+    case PROFILE_EVENTS: return "events";
+    case PROFILE_MOVEMENT: return "movement";
+    case PROFILE_SPAWNING: return "spawning";
+    case PROFILE_COLLISION: return "collision";
+    case PROFILE_COMPACTION: return "compaction";
+    case PROFILE_HUD: return "hud";
+    case PROFILE_DRAW: return "draw";
+    case PROFILE_PRESENT: return "present";
+    default: return "frame";
+    }
+}
+
+// Milliseconds over the frames in the history
+struct PhaseStats {
+    float p50 = 0;
+    float p95 = 0;
+    float p99 = 0;
+    float max = 0;
+};
+
+class Profiler {
+public:
+    static const int historySize = 1024;
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void add(int phase, double seconds) {
+        current[phase] += seconds;
+    }
+
+    void endFrame() {
+        Clock::time_point now = Clock::now();
+        current[PROFILE_FRAME] = std::chrono::duration<double>(now - frameStart).count();
+        frameStart = now;
+
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            history[phase][next] = static_cast<float>(current[phase] * 1000.0);
+            current[phase] = 0;
+        }
+        next = (next + 1) % historySize;
+        if (frames < historySize) frames++;
+    }
+
+    // Frames currently in the history
+    int frameCount() const {
+        return frames;
+    }
+
+    PhaseStats stats(int phase) const {
+        PhaseStats result;
+        if (frames == 0) return result;
+        sorted.assign(history[phase], history[phase] + frames);
+        std::sort(sorted.begin(), sorted.end());
+        result.p50 = percentile(0.50f);
+        result.p95 = percentile(0.95f);
+        result.p99 = percentile(0.99f);
+        result.max = sorted.back();
+        return result;
+    }
+
+    // One line per phase, for the on-screen overlay
+    std::string summary() const {
+        std::string text = "phase          p50     p95     p99  (ms)\n";
+        char line[64];
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            PhaseStats s = stats(phase);
+            std::snprintf(line, sizeof(line), "%-10s %7.3f %7.3f %7.3f\n", profilePhaseName(phase), s.p50, s.p95, s.p99);
+            text += line;
+        }
+        return text;
+    }
+
+    bool writeCsv(const std::string& filename) const {
+        std::FILE* file = std::fopen(filename.c_str(), "w");
+        if (!file) return false;
+        std::fprintf(file, "phase,frames,p50_ms,p95_ms,p99_ms,max_ms\n");
+        for (int phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+            PhaseStats s = stats(phase);
+            std::fprintf(file, "%s,%d,%.4f,%.4f,%.4f,%.4f\n", profilePhaseName(phase), frames, s.p50, s.p95, s.p99, s.max);
+        }
+        std::fclose(file);
+        return true;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double current[PROFILE_PHASE_COUNT] = {};
+    float history[PROFILE_PHASE_COUNT][historySize] = {};
+    int next = 0;
+    int frames = 0;
+    Clock::time_point frameStart = Clock::now();
+    mutable std::vector<float> sorted;
+
+    Profiler() {
+        sorted.reserve(historySize);
+    }
+
+    // Nearest-rank percentile of the sorted scratch copy
+    float percentile(float fraction) const {
+        int rank = static_cast<int>(std::ceil(fraction * sorted.size()));
+        return sorted[std::max(rank, 1) - 1];
+    }
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(int phase) : phase(phase), start(std::chrono::steady_clock::now()) {
+    }
+
+    ~ScopedTimer() {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        Profiler::instance().add(phase, elapsed.count());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    int phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(phase)
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "World.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const char replayMagic[4] = { 'H', 'T', 'Z', 'R' };
+
+// How a round ended, stored with a replay so playing it back can check
+// that the simulation did exactly the same thing
+struct ReplayOutcome {
+    std::uint64_t stateHash = 0; // hashWorld() after the last tick
+    std::uint32_t ticks = 0;
+    std::uint32_t enemiesSpawned = 0;
+    std::uint32_t kills = 0;
+    std::int32_t state = 0;
+    std::int32_t playerHealth = 0;
+    std::uint32_t reserved = 0; // keeps the struct free of padding, as it is written as is
+
+    bool operator==(const ReplayOutcome& other) const {
+        return ticks == other.ticks && enemiesSpawned == other.enemiesSpawned && kills == other.kills
+            && state == other.state && playerHealth == other.playerHealth && stateHash == other.stateHash;
+    }
+
+    bool operator!=(const ReplayOutcome& other) const {
+        return !(*this == other);
+    }
+};
+
+// FNV-1a over the exact bits of the player, enemy, bullet and powerup
+// state, so any difference in a replayed round shows up
+inline std::uint64_t hashWorld(const World& world) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    auto mixVector = [&mix](sf::Vector2f v) {
+        mix(&v.x, sizeof(v.x));
+        mix(&v.y, sizeof(v.y));
+    };
+
+    mixVector(world.player.sprite.getPosition());
+    mix(&world.player.health, sizeof(world.player.health));
+    mix(&world.timeTrialTimer, sizeof(world.timeTrialTimer));
+    for (int i = 0; i < world.enemies.count(); i++) {
+        mix(&world.enemies.x[i], sizeof(float));
+        mix(&world.enemies.y[i], sizeof(float));
+        mix(&world.enemies.active[i], sizeof(sf::Uint8));
+    }
+    auto mixPosition = [&mixVector](float x, float y) {
+        mixVector(sf::Vector2f(x, y));
+    };
+    world.bullets.each<POSITION_X, POSITION_Y>(mixPosition);
+    world.powerups.each<POSITION_X, POSITION_Y>(mixPosition);
+    return hash;
+}
+
+inline ReplayOutcome replayOutcome(const World& world, int ticks) {
+    ReplayOutcome outcome;
+    outcome.ticks = static_cast<std::uint32_t>(ticks);
+    outcome.enemiesSpawned = static_cast<std::uint32_t>(world.enemiesSpawned);
+    outcome.kills = static_cast<std::uint32_t>(world.state == PLAYING_CLASSIC || world.state == GAME_OVER || world.state == VICTORY
+        ? world.enemiesKilled : world.timeTrialKills);
+    outcome.state = world.state;
+    outcome.playerHealth = world.player.health;
+    outcome.stateHash = hashWorld(world);
+    return outcome;
+}
+
+// One round's seed and per-tick input. The World is deterministic given
+// its seed, arena and inputs, so stepping a fresh World through them
+// replays the round exactly, on the same build of the game.
+//
+// File layout (little-endian): a header with the seed, mode, arena size,
+// level and wave config file names, whether crowd separation was on and the
+// recorded outcome, then one record per tick. A record is a flags byte: movement as up/down/left/right bits, a bit set
+// when the aim target changed, and the shot count in the top 3 bits (7
+// means a 16-bit count follows). The new aim target follows as two floats
+// when it changed, so keyboard play with a steady aim costs one byte per
+// tick. Movement that is not made of whole WASD steps, like the headless
+// autopilot's, sets both up and down and follows as two floats.
+class Replay {
+public:
+    unsigned seed = 0;
+    GameState mode = PLAYING_TIME_TRIAL;
+    sf::Vector2f arenaSize = sf::Vector2f(1600, 900);
+    std::string level;
+    std::string waves; // wave config file, empty for the trickle of zombies
+    bool separation = false; // World::crowdSeparation
+    std::vector<PlayerInput> inputs;
+    ReplayOutcome outcome;
+
+    void begin(unsigned roundSeed, GameState roundMode, sf::Vector2f roundArenaSize, const std::string& roundLevel,
+        const std::string& roundWaves, bool roundSeparation) {
+        seed = roundSeed;
+        mode = roundMode;
+        arenaSize = roundArenaSize;
+        level = roundLevel;
+        waves = roundWaves;
+        separation = roundSeparation;
+        inputs.clear();
+        outcome = ReplayOutcome();
+    }
+
+    void record(const PlayerInput& input) {
+        inputs.push_back(input);
+    }
+
+    void finish(const World& world) {
+        outcome = replayOutcome(world, static_cast<int>(inputs.size()));
+    }
+
+    bool save(const std::string& filename) const {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) return false;
+        file.write(replayMagic, sizeof(replayMagic));
+        writeValue(file, static_cast<std::uint32_t>(version));
+        writeValue(file, static_cast<std::uint32_t>(seed));
+        writeValue(file, static_cast<std::int32_t>(mode));
+        writeValue(file, arenaSize.x);
+        writeValue(file, arenaSize.y);
+        writeValue(file, static_cast<std::uint16_t>(level.size()));
+        file.write(level.data(), level.size());
+        writeValue(file, static_cast<std::uint16_t>(waves.size()));
+        file.write(waves.data(), waves.size());
+        writeValue(file, static_cast<std::uint8_t>(separation ? 1 : 0));
+        writeValue(file, outcome);
+        writeValue(file, static_cast<std::uint32_t>(inputs.size()));
+
+        sf::Vector2f aim;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            const PlayerInput& input = inputs[i];
+            std::uint8_t flags = 0;
+            bool analog = !isStep(input.movement.x) || !isStep(input.movement.y);
+            if (analog) flags |= moveUp | moveDown;
+            else {
+                if (input.movement.y < 0) flags |= moveUp;
+                if (input.movement.y > 0) flags |= moveDown;
+                if (input.movement.x < 0) flags |= moveLeft;
+                if (input.movement.x > 0) flags |= moveRight;
+            }
+            bool aimChanged = i == 0 || std::memcmp(&input.aimTarget, &aim, sizeof(aim)) != 0;
+            if (aimChanged) flags |= aimMoved;
+            flags |= static_cast<std::uint8_t>(std::min(input.shots, static_cast<int>(shotsEscape)) << shotsShift);
+            writeValue(file, flags);
+            if (analog) {
+                writeValue(file, input.movement.x);
+                writeValue(file, input.movement.y);
+            }
+            if (input.shots >= shotsEscape) writeValue(file, static_cast<std::uint16_t>(input.shots));
+            if (aimChanged) {
+                writeValue(file, input.aimTarget.x);
+                writeValue(file, input.aimTarget.y);
+                aim = input.aimTarget;
+            }
+        }
+        return static_cast<bool>(file);
+    }
+
+    bool load(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        char fileMagic[sizeof(replayMagic)];
+        std::uint32_t fileVersion = 0, fileSeed = 0, tickCount = 0;
+        std::int32_t fileMode = 0;
+        std::uint16_t levelLength = 0, wavesLength = 0;
+        std::uint8_t fileSeparation = 0;
+        if (!file.read(fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, replayMagic, sizeof(replayMagic)) != 0) return false;
+        if (!readValue(file, fileVersion) || fileVersion != version) return false;
+        if (!readValue(file, fileSeed) || !readValue(file, fileMode) || !readValue(file, arenaSize.x)
+            || !readValue(file, arenaSize.y) || !readValue(file, levelLength)) return false;
+        level.assign(levelLength, '\0');
+        if (!file.read(&level[0], levelLength) || !readValue(file, wavesLength)) return false;
+        waves.assign(wavesLength, '\0');
+        if (!file.read(&waves[0], wavesLength) || !readValue(file, fileSeparation) || !readValue(file, outcome)
+            || !readValue(file, tickCount)) return false;
+        seed = fileSeed;
+        separation = fileSeparation != 0;
+        mode = static_cast<GameState>(fileMode);
+
+        inputs.assign(tickCount, PlayerInput());
+        sf::Vector2f aim;
+        for (PlayerInput& input : inputs) {
+            std::uint8_t flags;
+            if (!readValue(file, flags)) return false;
+            if ((flags & (moveUp | moveDown)) == (moveUp | moveDown)) {
+                if (!readValue(file, input.movement.x) || !readValue(file, input.movement.y)) return false;
+            }
+            else {
+                input.movement.x = static_cast<float>(((flags & moveRight) ? 1 : 0) - ((flags & moveLeft) ? 1 : 0));
+                input.movement.y = static_cast<float>(((flags & moveDown) ? 1 : 0) - ((flags & moveUp) ? 1 : 0));
+            }
+            input.shots = flags >> shotsShift;
+            if (input.shots == shotsEscape) {
+                std::uint16_t shots;
+                if (!readValue(file, shots)) return false;
+                input.shots = shots;
+            }
+            if (flags & aimMoved) {
+                if (!readValue(file, aim.x) || !readValue(file, aim.y)) return false;
+            }
+            input.aimTarget = aim;
+        }
+        return true;
+    }
+
+private:
+    enum {
+        version = 3,
+
+        moveUp = 1 << 0,
+        moveDown = 1 << 1,
+        moveLeft = 1 << 2,
+        moveRight = 1 << 3,
+        aimMoved = 1 << 4,
+        shotsShift = 5,
+        shotsEscape = 7
+    };
+
+    static bool isStep(float axis) {
+        return axis == -1.0f || axis == 0.0f || axis == 1.0f;
+    }
+
+    template <typename T>
+    static void writeValue(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static bool readValue(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+};
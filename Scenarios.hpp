@@ -0,0 +1,187 @@
+#pragma once
+
+#include "World.hpp"
+#include "AllocationCounter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Scripted stress scenarios for the benchmark program (BenchmarkMain.cpp).
+// Each one sets up a World, then steps it headlessly for a fixed number of
+// ticks with scripted input, timing every tick. Seeds are fixed, so two
+// runs of a scenario simulate exactly the same thing and their timings can
+// be compared across builds and machines.
+struct StressScenario {
+    const char* name;
+    const char* description;
+    int ticks;
+    void (*setup)(World& world);
+    PlayerInput (*input)(const World& world, int tick);
+};
+
+struct ScenarioResult {
+    std::string name;
+    int ticks = 0;          // actually stepped; fewer than asked if a time trial ran out
+    int threads = 1;
+    double meanMs = 0;      // per tick
+    double p99Ms = 0;
+    double maxMs = 0;
+    long long allocations = 0;
+    double entitiesPerSecond = 0; // entity updates: live entities summed over ticks, per second of stepping
+    int peakEntities = 0;
+    int enemiesSpawned = 0;
+    int kills = 0;
+    long long transformsSaved = 0; // by the collision proxies (see CollisionProxy)
+};
+
+// Live entities after a tick: the player, enemies, bullets and powerups
+inline int countEntities(const World& world) {
+    return world.entities.liveCount();
+}
+
+// A thousand zombies placed on a ring around the player walk in at once
+inline void setupConvergeScenario(World& world) {
+    world.timeTrialDuration = 1000;
+    world.enemySpawnDelay = 1000; // only the ring, no regular spawns
+    world.start(PLAYING_TIME_TRIAL, 42);
+    sf::Vector2f center = world.player.getCenter();
+    const int count = 1000;
+    for (int i = 0; i < count; i++) {
+        float angle = 6.2831853f * i / count;
+        float radius = 1.0f + (i % 4) * 0.04f; // a few rows deep
+        EnemyType type = (i % 5 < 3) ? ENEMY_TYPE_1 : ENEMY_TYPE_2;
+        world.enemies.spawn(center.x + cos(angle) * 700 * radius, center.y + sin(angle) * 400 * radius, type, world.rng);
+    }
+    world.enemiesSpawned = count;
+}
+
+inline PlayerInput standStillInput(const World& world, int) {
+    PlayerInput input;
+    input.aimTarget = world.player.getCenter() + sf::Vector2f(1, 0);
+    return input;
+}
+
+// The bullet store is enlarged so 2000 bullets can be in flight, with
+// zombies streaming in for them to hit
+inline void setupBulletHoseScenario(World& world) {
+    world.bullets.setCapacity(4096);
+    world.timeTrialDuration = 1000;
+    world.enemySpawnDelay = 0.05f;
+    world.start(PLAYING_TIME_TRIAL, 42);
+}
+
+// Tops the bullets in flight back up to 2000 every tick, sweeping the aim
+// around the player
+inline PlayerInput bulletHoseInput(const World& world, int tick) {
+    PlayerInput input;
+    float angle = tick * 0.05f;
+    input.aimTarget = world.player.getCenter() + sf::Vector2f(cos(angle), sin(angle));
+    input.shots = std::max(0, 2000 - world.bullets.count());
+    return input;
+}
+
+// A powerup every tick; each lasts 10 seconds, so over a thousand are out
+inline void setupPowerupStormScenario(World& world) {
+    world.timeTrialDuration = 1000;
+    world.powerupSpawnDelay = SIMULATION_STEP;
+    world.start(PLAYING_TIME_TRIAL, 42);
+}
+
+// A regular 60 second time trial with a zombie spawned every tick
+inline void setupMaxSpawnScenario(World& world) {
+    world.enemySpawnDelay = 0;
+    world.start(PLAYING_TIME_TRIAL, 42);
+}
+
+// Bursts of hundreds of zombies from the wave director, landing within
+// its spawn budget
+inline void setupWaveBurstScenario(World& world) {
+    world.timeTrialDuration = 1000;
+    world.waves.loadFromString("budget 16\nwave count=500 time=0 ramp=burst pause=2\nwave count=300 time=1 ramp=ease-in edges=1,0,0,1 pause=2\n");
+    world.start(PLAYING_TIME_TRIAL, 42);
+}
+
+inline const std::vector<StressScenario>& stressScenarios() {
+    static const std::vector<StressScenario> scenarios = {
+        { "converge", "1k zombies converge on the player", 1200, setupConvergeScenario, standStillInput },
+        { "bullet-hose", "bullet hose: 2000 live bullets", 1200, setupBulletHoseScenario, bulletHoseInput },
+        { "powerup-storm", "powerup storm: a powerup spawned every tick", 2400, setupPowerupStormScenario, autopilotInput },
+        { "time-trial-max-spawn", "time trial, 60 s at max spawn rate", 7200, setupMaxSpawnScenario, autopilotInput },
+        { "wave-burst", "waves of 300-500 zombies arriving at once", 1200, setupWaveBurstScenario, autopilotInput },
+    };
+    return scenarios;
+}
+
+inline const StressScenario* findStressScenario(const std::string& name) {
+    for (const StressScenario& scenario : stressScenarios()) {
+        if (name == scenario.name) return &scenario;
+    }
+    return nullptr;
+}
+
+inline ScenarioResult runScenario(const StressScenario& scenario, const GameArt& art) {
+    typedef std::chrono::steady_clock Clock;
+    World world(art, 42);
+    scenario.setup(world);
+
+    ScenarioResult result;
+    result.name = scenario.name;
+    result.threads = world.jobs->threadCount();
+    std::vector<double> tickMs;
+    tickMs.reserve(scenario.ticks);
+    double totalSeconds = 0;
+    double entityTicks = 0;
+
+    long long before = heapAllocations();
+    for (int tick = 0; tick < scenario.ticks && world.isPlaying(); tick++) {
+        // The player cannot die, so every scenario runs its full length:
+        // this is far more than a tick of contact damage from the whole horde
+        world.player.health = 1000000;
+        PlayerInput input = scenario.input(world, tick);
+        TickEvents events;
+        Clock::time_point start = Clock::now();
+        world.step(SIMULATION_STEP, input, events);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        tickMs.push_back(seconds * 1000.0);
+        totalSeconds += seconds;
+        int entities = countEntities(world);
+        entityTicks += entities;
+        result.peakEntities = std::max(result.peakEntities, entities);
+        result.kills += events.enemiesKilled;
+    }
+    result.allocations = heapAllocations() - before;
+    result.transformsSaved = world.transformsSaved();
+
+    result.ticks = static_cast<int>(tickMs.size());
+    result.enemiesSpawned = world.enemiesSpawned;
+    if (result.ticks > 0) {
+        result.meanMs = totalSeconds * 1000.0 / result.ticks;
+        result.entitiesPerSecond = totalSeconds > 0 ? entityTicks / totalSeconds : 0;
+        std::sort(tickMs.begin(), tickMs.end());
+        result.p99Ms = tickMs[std::min(result.ticks - 1, result.ticks * 99 / 100)];
+        result.maxMs = tickMs.back();
+    }
+    return result;
+}
+
+// Results as a JSON array, one object per scenario
+inline std::string scenarioResultsJson(const std::vector<ScenarioResult>& results) {
+    std::string json = "[\n";
+    char line[512];
+    for (size_t i = 0; i < results.size(); i++) {
+        const ScenarioResult& r = results[i];
+        std::snprintf(line, sizeof(line),
+            "  {\"scenario\": \"%s\", \"ticks\": %d, \"threads\": %d, \"ms_per_tick_mean\": %.4f, \"ms_per_tick_p99\": %.4f, "
+            "\"ms_per_tick_max\": %.4f, \"allocations\": %lld, \"entities_per_second\": %.0f, \"peak_entities\": %d, "
+            "\"enemies_spawned\": %d, \"kills\": %d, \"transforms_saved\": %lld}%s\n",
+            r.name.c_str(), r.ticks, r.threads, r.meanMs, r.p99Ms, r.maxMs, r.allocations, r.entitiesPerSecond,
+            r.peakEntities, r.enemiesSpawned, r.kills, r.transformsSaved, i + 1 < results.size() ? "," : "");
+        json += line;
+    }
+    json += "]\n";
+    return json;
+}
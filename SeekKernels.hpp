@@ -0,0 +1,196 @@
+#pragma once
+
+#include "Entities.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define SIMD_X86 0
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions marked for it;
+// MSVC accepts the intrinsics anywhere
+#if SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_SSE2
+#endif
+
+// Instruction sets the enemy seek kernel can use, best last
+enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2
+};
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_AVX2: return "avx2";
+    case SIMD_SSE2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+inline SimdLevel detectSimdLevel() {
+#if SIMD_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osSavesYmm) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    return avx2 ? SIMD_AVX2 : sse2 ? SIMD_SSE2 : SIMD_SCALAR;
+#elif SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+    return SIMD_SCALAR;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+// Best level this CPU supports, detected once
+inline SimdLevel bestSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+// Arguments for one sweep of the seek-toward-player update over EnemyStore
+// arrays. Enemy positions are sprite corners, so each type carries the half
+// size that turns a corner into a centre.
+struct SeekBatch {
+    float* x;
+    float* y;
+    const float* speed;
+    const EnemyType* type;
+    const sf::Uint8* active;
+    int count;
+    float halfWidth[2];
+    float halfHeight[2];
+    float targetX;
+    float targetY;
+    float deltaTime;
+};
+
+// All kernels perform the same IEEE operations in the same order (sqrt and
+// division are exactly rounded in every path), so they produce bit-identical
+// positions and the choice of kernel never changes the simulation.
+inline void seekScalar(const SeekBatch& b, int first = 0) {
+    for (int i = first; i < b.count; i++) {
+        if (!b.active[i]) continue;
+        float dx = b.targetX - (b.x[i] + b.halfWidth[b.type[i]]);
+        float dy = b.targetY - (b.y[i] + b.halfHeight[b.type[i]]);
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length > 0) {
+            float step = b.speed[i] * b.deltaTime / length;
+            b.x[i] += dx * step;
+            b.y[i] += dy * step;
+        }
+    }
+}
+
+#if SIMD_X86
+static_assert(sizeof(EnemyType) == 4, "SIMD seek kernels load enemy types as 32-bit lanes");
+
+SIMD_TARGET_SSE2 inline void seekSse2(const SeekBatch& b) {
+    const __m128 targetX = _mm_set1_ps(b.targetX);
+    const __m128 targetY = _mm_set1_ps(b.targetY);
+    const __m128 deltaTime = _mm_set1_ps(b.deltaTime);
+    const __m128 halfWidth1 = _mm_set1_ps(b.halfWidth[ENEMY_TYPE_1]);
+    const __m128 halfWidth2 = _mm_set1_ps(b.halfWidth[ENEMY_TYPE_2]);
+    const __m128 halfHeight1 = _mm_set1_ps(b.halfHeight[ENEMY_TYPE_1]);
+    const __m128 halfHeight2 = _mm_set1_ps(b.halfHeight[ENEMY_TYPE_2]);
+    const __m128i type1 = _mm_set1_epi32(ENEMY_TYPE_1);
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= b.count; i += 4) {
+        __m128 x = _mm_loadu_ps(b.x + i);
+        __m128 y = _mm_loadu_ps(b.y + i);
+
+        __m128 isType1 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b.type + i)), type1));
+        __m128 halfWidth = _mm_or_ps(_mm_and_ps(isType1, halfWidth1), _mm_andnot_ps(isType1, halfWidth2));
+        __m128 halfHeight = _mm_or_ps(_mm_and_ps(isType1, halfHeight1), _mm_andnot_ps(isType1, halfHeight2));
+
+        __m128 dx = _mm_sub_ps(targetX, _mm_add_ps(x, halfWidth));
+        __m128 dy = _mm_sub_ps(targetY, _mm_add_ps(y, halfHeight));
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+        int activeBytes;
+        std::memcpy(&activeBytes, b.active + i, 4);
+        __m128i activeLanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(activeBytes), zero), zero);
+        __m128 move = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(activeLanes, zero)), _mm_cmpgt_ps(length, _mm_setzero_ps()));
+
+        __m128 step = _mm_and_ps(move, _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(b.speed + i), deltaTime), length));
+        _mm_storeu_ps(b.x + i, _mm_add_ps(x, _mm_mul_ps(dx, step)));
+        _mm_storeu_ps(b.y + i, _mm_add_ps(y, _mm_mul_ps(dy, step)));
+    }
+    seekScalar(b, i);
+}
+
+SIMD_TARGET_AVX2 inline void seekAvx2(const SeekBatch& b) {
+    const __m256 targetX = _mm256_set1_ps(b.targetX);
+    const __m256 targetY = _mm256_set1_ps(b.targetY);
+    const __m256 deltaTime = _mm256_set1_ps(b.deltaTime);
+    const __m256 halfWidth1 = _mm256_set1_ps(b.halfWidth[ENEMY_TYPE_1]);
+    const __m256 halfWidth2 = _mm256_set1_ps(b.halfWidth[ENEMY_TYPE_2]);
+    const __m256 halfHeight1 = _mm256_set1_ps(b.halfHeight[ENEMY_TYPE_1]);
+    const __m256 halfHeight2 = _mm256_set1_ps(b.halfHeight[ENEMY_TYPE_2]);
+    const __m256i type1 = _mm256_set1_epi32(ENEMY_TYPE_1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i + 8 <= b.count; i += 8) {
+        __m256 x = _mm256_loadu_ps(b.x + i);
+        __m256 y = _mm256_loadu_ps(b.y + i);
+
+        __m256 isType1 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.type + i)), type1));
+        __m256 halfWidth = _mm256_blendv_ps(halfWidth2, halfWidth1, isType1);
+        __m256 halfHeight = _mm256_blendv_ps(halfHeight2, halfHeight1, isType1);
+
+        __m256 dx = _mm256_sub_ps(targetX, _mm256_add_ps(x, halfWidth));
+        __m256 dy = _mm256_sub_ps(targetY, _mm256_add_ps(y, halfHeight));
+        __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+
+        __m256i activeLanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b.active + i)));
+        __m256 move = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(activeLanes, zero)),
+            _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ));
+
+        __m256 step = _mm256_and_ps(move, _mm256_div_ps(_mm256_mul_ps(_mm256_loadu_ps(b.speed + i), deltaTime), length));
+        _mm256_storeu_ps(b.x + i, _mm256_add_ps(x, _mm256_mul_ps(dx, step)));
+        _mm256_storeu_ps(b.y + i, _mm256_add_ps(y, _mm256_mul_ps(dy, step)));
+    }
+    seekScalar(b, i);
+}
+#endif
+
+// Runs the sweep with the requested kernel, falling back to the best one
+// this build and CPU can actually run
+inline void seekTowards(const SeekBatch& batch, SimdLevel level) {
+    if (level > bestSimdLevel()) level = bestSimdLevel();
+#if SIMD_X86
+    if (level == SIMD_AVX2) {
+        seekAvx2(batch);
+        return;
+    }
+    if (level == SIMD_SSE2) {
+        seekSse2(batch);
+        return;
+    }
+#endif
+    seekScalar(batch);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Kinds of sound effect, each with its own voice limit
+enum SoundCategory {
+    SOUND_SHOT,
+    SOUND_HIT,
+    SOUND_CATEGORY_COUNT
+};
+
+// A fixed set of sf::Sound voices shared by every sound effect. Each
+// sf::Sound holds an OpenAL source, so the number of sources in use never
+// goes above the pool size however busy a fight gets.
+//
+// A new sound takes a free voice if there is one. Otherwise it steals the
+// voice of a sound with a lower or equal priority, the oldest one first,
+// or is dropped if every voice plays something more important. A category
+// at its limit only steals from itself, so a burst of one kind of sound
+// cannot drown out the rest. Volume falls off with distance from the
+// listener, and sounds out of earshot are dropped without taking a voice.
+class SoundPool {
+public:
+    int played = 0;  // sounds started
+    int stolen = 0;  // sounds cut off to make room for a new one
+    int dropped = 0; // sounds not played: out of earshot or no voice to take
+
+    explicit SoundPool(int voiceCount = 16) : voices(std::max(1, voiceCount)) {
+        std::fill(categoryLimits, categoryLimits + SOUND_CATEGORY_COUNT, static_cast<int>(voices.size()));
+    }
+
+    void setCategoryLimit(SoundCategory category, int limit) {
+        categoryLimits[category] = std::max(1, limit);
+    }
+
+    // Sounds at the listener play at full volume, fading out to silence at
+    // hearingRadius
+    void setListener(sf::Vector2f position, float hearingRadius) {
+        listener = position;
+        radius = hearingRadius;
+    }
+
+    // Returns whether the sound got a voice
+    bool play(const sf::SoundBuffer& buffer, SoundCategory category, int priority, sf::Vector2f position, float volume = 100) {
+        float dx = position.x - listener.x;
+        float dy = position.y - listener.y;
+        float falloff = 1.0f - std::sqrt(dx * dx + dy * dy) / radius;
+        if (falloff <= 0) {
+            dropped++;
+            return false;
+        }
+
+        // Only voices of this category compete once it is at its limit
+        bool categoryFull = activeCount(category) >= categoryLimits[category];
+        Voice* chosen = nullptr;
+        for (Voice& voice : voices) {
+            bool playing = voice.sound.getStatus() == sf::Sound::Playing;
+            if (!playing) {
+                if (!categoryFull) {
+                    chosen = &voice;
+                    break;
+                }
+                continue;
+            }
+            if (categoryFull && voice.category != category) continue;
+            if (voice.priority > priority) continue;
+            if (!chosen || voice.priority < chosen->priority
+                || (voice.priority == chosen->priority && voice.started < chosen->started)) {
+                chosen = &voice;
+            }
+        }
+        if (!chosen) {
+            dropped++;
+            return false;
+        }
+        if (chosen->sound.getStatus() == sf::Sound::Playing) {
+            stolen++;
+        }
+
+        chosen->sound.stop();
+        chosen->sound.setBuffer(buffer);
+        chosen->sound.setVolume(volume * falloff);
+        chosen->category = category;
+        chosen->priority = priority;
+        chosen->started = ++startCount;
+        chosen->sound.play();
+        played++;
+        return true;
+    }
+
+    int activeCount(SoundCategory category) const {
+        int count = 0;
+        for (const Voice& voice : voices) {
+            if (voice.category == category && voice.sound.getStatus() == sf::Sound::Playing) count++;
+        }
+        return count;
+    }
+
+    int activeCount() const {
+        int count = 0;
+        for (const Voice& voice : voices) {
+            if (voice.sound.getStatus() == sf::Sound::Playing) count++;
+        }
+        return count;
+    }
+
+    int voiceCount() const {
+        return static_cast<int>(voices.size());
+    }
+
+private:
+    struct Voice {
+        sf::Sound sound;
+        SoundCategory category = SOUND_SHOT;
+        int priority = 0;
+        unsigned started = 0; // when play() gave it its sound, for oldest-first stealing
+    };
+
+    std::vector<Voice> voices;
+    int categoryLimits[SOUND_CATEGORY_COUNT];
+    sf::Vector2f listener;
+    float radius = 1000;
+    unsigned startCount = 0;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Uniform grid over the arena used as a collision broad-phase. Items are
+// bucketed by the cell holding their centre, so a query widens the searched
+// area by the largest half-size seen during the build. The grid is rebuilt
+// from scratch every tick with a counting sort, which keeps items in index
+// order within each cell and reuses its buffers once they have grown.
+class SpatialHash {
+public:
+    SpatialHash(float width = 1600, float height = 900, float cellSize = 64) {
+        resize(width, height, cellSize);
+    }
+
+    void resize(float width, float height, float newCellSize) {
+        cellSize = newCellSize;
+        columns = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+        rows = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+        cellStart.assign(columns * rows + 1, 0);
+    }
+
+    // getBounds(i) must return the sf::FloatRect of item i
+    template <typename GetBounds>
+    void build(int count, GetBounds getBounds) {
+        itemCell.resize(count);
+        items.resize(count);
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+        maxHalfWidth = 0;
+        maxHalfHeight = 0;
+
+        for (int i = 0; i < count; i++) {
+            sf::FloatRect bounds = getBounds(i);
+            float halfWidth = bounds.width / 2;
+            float halfHeight = bounds.height / 2;
+            maxHalfWidth = std::max(maxHalfWidth, halfWidth);
+            maxHalfHeight = std::max(maxHalfHeight, halfHeight);
+            int cell = cellIndex(cellColumn(bounds.left + halfWidth), cellRow(bounds.top + halfHeight));
+            itemCell[i] = cell;
+            cellStart[cell + 1]++;
+        }
+
+        for (size_t cell = 1; cell < cellStart.size(); cell++) {
+            cellStart[cell] += cellStart[cell - 1];
+        }
+
+        cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; i++) {
+            items[cellFill[itemCell[i]]++] = i;
+        }
+    }
+
+    // Drops the items for which kept(i) is false and renumbers the rest to
+    // their index among the kept ones, as compacting the arrays they index
+    // does. Items stay in their cells and in order, so this leaves the grid
+    // a rebuild would give when nothing has moved, without reading any
+    // bounds again. The query margin stays that of the last build.
+    template <typename IsKept>
+    void compact(IsKept kept) {
+        const int count = static_cast<int>(itemCell.size());
+        newIndex.resize(count);
+        int next = 0;
+        for (int i = 0; i < count; i++) {
+            newIndex[i] = kept(i) ? next++ : -1;
+            if (newIndex[i] >= 0) itemCell[newIndex[i]] = itemCell[i];
+        }
+        itemCell.resize(next);
+
+        int write = 0, readStart = 0;
+        const int cells = cellCount();
+        for (int cell = 0; cell < cells; cell++) {
+            const int readEnd = cellStart[cell + 1];
+            cellStart[cell] = write;
+            for (int slot = readStart; slot < readEnd; slot++) {
+                int index = newIndex[items[slot]];
+                if (index >= 0) items[write++] = index;
+            }
+            readStart = readEnd;
+        }
+        cellStart[cells] = write;
+        items.resize(write);
+    }
+
+    void clear() {
+        items.clear();
+        itemCell.clear();
+        std::fill(cellStart.begin(), cellStart.end(), 0);
+    }
+
+    // Calls visit(i) for every item whose centre cell could overlap area
+    template <typename Visit>
+    void query(const sf::FloatRect& area, Visit visit) const {
+        int minColumn = cellColumn(area.left - maxHalfWidth);
+        int maxColumn = cellColumn(area.left + area.width + maxHalfWidth);
+        int minRow = cellRow(area.top - maxHalfHeight);
+        int maxRow = cellRow(area.top + area.height + maxHalfHeight);
+
+        for (int row = minRow; row <= maxRow; row++) {
+            for (int column = minColumn; column <= maxColumn; column++) {
+                int cell = cellIndex(column, row);
+                for (int slot = cellStart[cell]; slot < cellStart[cell + 1]; slot++) {
+                    visit(items[slot]);
+                }
+            }
+        }
+    }
+
+    // Calls visit(i, slot) for every item whose centre could be within
+    // radius of point, starting with the cell holding point so the nearest
+    // items come first, then the cells around it. The area is not widened
+    // by item sizes, as only centres are compared. slot is the item's place
+    // in cell order (see itemAt()), so callers can keep a copy of what they
+    // compare in that order and read it sequentially. Stops once visit
+    // returns false.
+    template <typename Visit>
+    void queryNear(sf::Vector2f point, float radius, Visit visit) const {
+        int homeColumn = cellColumn(point.x);
+        int homeRow = cellRow(point.y);
+        if (!visitCell(cellIndex(homeColumn, homeRow), visit)) return;
+        int minColumn = cellColumn(point.x - radius);
+        int maxColumn = cellColumn(point.x + radius);
+        int minRow = cellRow(point.y - radius);
+        int maxRow = cellRow(point.y + radius);
+        for (int row = minRow; row <= maxRow; row++) {
+            for (int column = minColumn; column <= maxColumn; column++) {
+                if (column == homeColumn && row == homeRow) continue;
+                if (!visitCell(cellIndex(column, row), visit)) return;
+            }
+        }
+    }
+
+    int cellCount() const {
+        return columns * rows;
+    }
+
+    // Items in cell order, each cell's items in index order
+    int itemCount() const {
+        return static_cast<int>(items.size());
+    }
+
+    int itemAt(int slot) const {
+        return items[slot];
+    }
+
+private:
+    float cellSize = 64;
+    int columns = 1;
+    int rows = 1;
+    float maxHalfWidth = 0;
+    float maxHalfHeight = 0;
+
+    std::vector<int> cellStart; // prefix sums: items of cell c are items[cellStart[c]..cellStart[c + 1])
+    std::vector<int> cellFill;
+    std::vector<int> itemCell;
+    std::vector<int> items;
+    std::vector<int> newIndex; // scratch for compact()
+
+    // Entities outside the arena are clamped into the border cells
+    int cellColumn(float x) const {
+        return std::max(0, std::min(columns - 1, static_cast<int>(std::floor(x / cellSize))));
+    }
+
+    int cellRow(float y) const {
+        return std::max(0, std::min(rows - 1, static_cast<int>(std::floor(y / cellSize))));
+    }
+
+    int cellIndex(int column, int row) const {
+        return row * columns + column;
+    }
+
+    template <typename Visit>
+    bool visitCell(int cell, Visit& visit) const {
+        for (int slot = cellStart[cell]; slot < cellStart[cell + 1]; slot++) {
+            if (!visit(items[slot], slot)) return false;
+        }
+        return true;
+    }
+};
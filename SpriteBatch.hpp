@@ -0,0 +1,113 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <vector>
+
+// Collects sprites and shapes into one triangle vertex array per texture
+// and draws each array with a single call, so the number of draw calls
+// depends on how many textures are in use rather than on how many
+// entities are on screen. Batches are drawn in the order their texture was
+// first seen; within a batch, things are drawn in the order they were added.
+class SpriteBatch {
+public:
+    // Counters for the last draw(), for checking the batching works
+    int drawCalls = 0;
+    int vertexCount = 0;
+
+    // Starts a new frame. Vertex arrays keep their capacity between frames.
+    void begin() {
+        for (auto& batch : batches) {
+            batch.vertices.clear();
+        }
+    }
+
+    // Textured quad: rect of texture (in texels), placed by transform
+    void add(const sf::Texture* texture, const sf::IntRect& rect, const sf::Transform& transform, sf::Color color = sf::Color::White) {
+        float width = static_cast<float>(std::abs(rect.width));
+        float height = static_cast<float>(std::abs(rect.height));
+        float left = static_cast<float>(rect.left);
+        float top = static_cast<float>(rect.top);
+        float right = left + rect.width;
+        float bottom = top + rect.height;
+
+        sf::Vertex topLeft(transform.transformPoint(0, 0), color, sf::Vector2f(left, top));
+        sf::Vertex topRight(transform.transformPoint(width, 0), color, sf::Vector2f(right, top));
+        sf::Vertex bottomLeft(transform.transformPoint(0, height), color, sf::Vector2f(left, bottom));
+        sf::Vertex bottomRight(transform.transformPoint(width, height), color, sf::Vector2f(right, bottom));
+
+        sf::VertexArray& vertices = batchFor(texture);
+        vertices.append(topLeft);
+        vertices.append(topRight);
+        vertices.append(bottomLeft);
+        vertices.append(bottomLeft);
+        vertices.append(topRight);
+        vertices.append(bottomRight);
+    }
+
+    // offset moves the sprite without touching it, e.g. for interpolation
+    void add(const sf::Sprite& sprite, sf::Vector2f offset = sf::Vector2f(0, 0)) {
+        sf::Transform transform;
+        transform.translate(offset).combine(sprite.getTransform());
+        add(sprite.getTexture(), sprite.getTextureRect(), transform, sprite.getColor());
+    }
+
+    // Lets untextured shapes share a textured batch: they are drawn from
+    // texture with every vertex sampling the opaque white texel at texCoords
+    void setSolidTexel(const sf::Texture* texture, sf::Vector2f texCoords) {
+        solidTexture = texture;
+        solidTexCoords = texCoords;
+    }
+
+    // Untextured shape fill (no outline), as a fan of triangles
+    void add(const sf::Shape& shape, sf::Vector2f offset = sf::Vector2f(0, 0)) {
+        std::size_t pointCount = shape.getPointCount();
+        if (pointCount < 3) return;
+
+        sf::Transform transform;
+        transform.translate(offset).combine(shape.getTransform());
+        sf::Color color = shape.getFillColor();
+        sf::VertexArray& vertices = batchFor(solidTexture);
+        sf::Vector2f first = transform.transformPoint(shape.getPoint(0));
+        sf::Vector2f previous = transform.transformPoint(shape.getPoint(1));
+        for (std::size_t i = 2; i < pointCount; i++) {
+            sf::Vector2f current = transform.transformPoint(shape.getPoint(i));
+            vertices.append(sf::Vertex(first, color, solidTexCoords));
+            vertices.append(sf::Vertex(previous, color, solidTexCoords));
+            vertices.append(sf::Vertex(current, color, solidTexCoords));
+            previous = current;
+        }
+    }
+
+    void draw(sf::RenderTarget& target) {
+        drawCalls = 0;
+        vertexCount = 0;
+        for (const auto& batch : batches) {
+            if (batch.vertices.getVertexCount() == 0) continue;
+            sf::RenderStates states;
+            states.texture = batch.texture;
+            target.draw(batch.vertices, states);
+            drawCalls++;
+            vertexCount += static_cast<int>(batch.vertices.getVertexCount());
+        }
+    }
+
+private:
+    struct Batch {
+        const sf::Texture* texture;
+        sf::VertexArray vertices;
+    };
+
+    std::vector<Batch> batches;
+    const sf::Texture* solidTexture = nullptr;
+    sf::Vector2f solidTexCoords;
+
+    // Only a handful of textures exist, so a linear search beats a map
+    sf::VertexArray& batchFor(const sf::Texture* texture) {
+        for (auto& batch : batches) {
+            if (batch.texture == texture) return batch.vertices;
+        }
+        batches.push_back(Batch{ texture, sf::VertexArray(sf::Triangles) });
+        return batches.back().vertices;
+    }
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Entities.hpp"
+#include "Log.hpp"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Packs rectangles of the given sizes into rows ("shelves") no wider than
+// maxWidth, tallest first, with padding pixels around each one. Returns the
+// placed rects in input order and the size of the area they use.
+inline std::vector<sf::IntRect> packShelves(const std::vector<sf::Vector2u>& sizes, unsigned maxWidth, unsigned padding, sf::Vector2u& packedSize) {
+    std::vector<int> order(sizes.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return sizes[a].y > sizes[b].y; });
+
+    std::vector<sf::IntRect> rects(sizes.size());
+    unsigned x = padding, y = padding, shelfHeight = 0, usedWidth = 0;
+    for (int i : order) {
+        sf::Vector2u size = sizes[i];
+        if (x + size.x + padding > maxWidth && x > padding) {
+            y += shelfHeight + padding;
+            x = padding;
+            shelfHeight = 0;
+        }
+        rects[i] = sf::IntRect(x, y, size.x, size.y);
+        x += size.x + padding;
+        usedWidth = std::max(usedWidth, x);
+        shelfHeight = std::max(shelfHeight, size.y);
+    }
+    packedSize = sf::Vector2u(usedWidth, y + shelfHeight + padding);
+    return rects;
+}
+
+// One texture holding every entity image, so sprites only differ in their
+// texture rect and a whole frame of them can go through one batch. A small
+// opaque white block is packed in as well, for drawing untextured shapes
+// from the same texture.
+class TextureAtlas {
+public:
+    sf::Texture texture;
+
+    // Queues an image for the next build()
+    void add(const std::string& name, const sf::Image& image) {
+        pending.push_back(Pending{ name, image });
+    }
+
+    // Packs and uploads every queued image. Returns false if they do not
+    // fit in the largest texture the GPU supports.
+    bool build() {
+        return pack(sf::Texture::getMaximumSize()) && upload();
+    }
+
+    // The CPU half of build(): lays the queued images out into one image
+    // no larger than maxSize on a side. Needs no GL context, so it can run
+    // on a loader thread once maxSize has been queried from
+    // sf::Texture::getMaximumSize() on the main thread.
+    bool pack(unsigned maxSize) {
+        sf::Image white;
+        white.create(solidSize, solidSize, sf::Color::White);
+        pending.push_back(Pending{ solidName, white });
+
+        std::vector<sf::Vector2u> sizes;
+        for (const auto& item : pending) sizes.push_back(item.image.getSize());
+
+        // Rows are kept to 2048 wide, which every GPU SFML runs on supports
+        sf::Vector2u packedSize;
+        std::vector<sf::IntRect> placed = packShelves(sizes, std::min(maxSize, 2048u), padding, packedSize);
+        if (packedSize.x > maxSize || packedSize.y > maxSize) {
+            LOG_ERROR("Texture atlas needs %ux%u but the GPU allows %u", packedSize.x, packedSize.y, maxSize);
+            pending.clear();
+            return false;
+        }
+
+        packed.create(packedSize.x, packedSize.y, sf::Color::Transparent);
+        for (size_t i = 0; i < pending.size(); i++) {
+            packed.copy(pending[i].image, placed[i].left, placed[i].top);
+            rects[pending[i].name] = placed[i];
+        }
+        pending.clear();
+
+        LOG_INFO("Texture atlas packed into %ux%u", packedSize.x, packedSize.y);
+        return true;
+    }
+
+    // The GPU half of build(): uploads what pack() laid out
+    bool upload() {
+        bool loaded = texture.loadFromImage(packed);
+        packed = sf::Image();
+        return loaded;
+    }
+
+    sf::IntRect rect(const std::string& name) const {
+        auto found = rects.find(name);
+        return found != rects.end() ? found->second : sf::IntRect();
+    }
+
+    SpriteArt art(const std::string& name) const {
+        SpriteArt art;
+        art.texture = &texture;
+        art.rect = rect(name);
+        return art;
+    }
+
+    // Texture coordinates of a pixel that is always opaque white
+    sf::Vector2f solidTexel() const {
+        sf::IntRect solid = rect(solidName);
+        return sf::Vector2f(solid.left + solid.width / 2.0f, solid.top + solid.height / 2.0f);
+    }
+
+private:
+    struct Pending {
+        std::string name;
+        sf::Image image;
+    };
+
+    static constexpr unsigned padding = 2;
+    static constexpr unsigned solidSize = 4;
+    const std::string solidName = "#solid";
+
+    std::vector<Pending> pending;
+    sf::Image packed;
+    std::unordered_map<std::string, sf::IntRect> rects;
+};
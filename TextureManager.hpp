@@ -0,0 +1,130 @@
+#pragma once
+
+#include "AssetArchive.hpp"
+#include "AssetLoader.hpp"
+#include "Entities.hpp"
+#include "Log.hpp"
+#include "TextureAtlas.hpp"
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Texture manager to hold shared textures. Entity images are packed into
+// one atlas so every sprite shares a texture; the background stays separate.
+// Images are decoded on loader threads and uploaded on the main thread.
+class TextureManager {
+public:
+    TextureAtlas atlas;
+    sf::Texture backgroundTexture;
+
+    // Queues every texture on loader; they are usable once it is done.
+    // Images found in archive are read from it, the rest from loose files.
+    void queue(AssetLoader& loader, const AssetArchive& archive) {
+        // The loader thread that packs the atlas has no GL context to ask
+        maxAtlasSize = sf::Texture::getMaximumSize();
+
+        // Player texture
+        addImage("player", "player.png", 50, 50, sf::Color::Blue, "blue", "Player texture loaded successfully");
+
+        // Enemy textures
+        addImage("enemy1", "enemy1.png", 40, 40, sf::Color::Red, "red", "Enemy1 texture loaded successfully");
+        addImage("enemy2", "enemy2.png", 40, 40, sf::Color::Magenta, "magenta", "Enemy2 texture loaded successfully");
+
+        // Powerup textures
+        addImage("health", "health.png", 30, 30, sf::Color::Green, "green", "Health powerup texture loaded successfully");
+        addImage("speed", "speed.png", 30, 30, sf::Color::Cyan, "cyan", "Speed powerup texture loaded successfully");
+
+        // Level tile textures
+        addImage("floor", "floor.png", 32, 32, sf::Color(60, 60, 60), "grey", "Floor tile texture loaded successfully");
+        addImage("wall", "wall.png", 32, 32, sf::Color(120, 120, 120), "light grey", "Wall tile texture loaded successfully");
+        addImage("destructible", "destructible.png", 32, 32, sf::Color(140, 90, 40), "brown", "Destructible tile texture loaded successfully");
+
+        // images is complete now, so the loader can hold on to its elements
+        for (AtlasImage& image : images) {
+            loader.add([this, &image, &archive] {
+                image.decode(archive);
+                if (++imagesDecoded == images.size()) packAtlas();
+            }, [this] { uploadAtlasImage(); });
+        }
+
+        // Background texture
+        loader.add([this, &archive] {
+            if (!archive.loadImage(backgroundImage, "3858.jpg") && !backgroundImage.loadFromFile("3858.jpg")) {
+                //if (!backgroundImage.loadFromFile("ground3.png")) {
+                backgroundImage.create(1600, 900, sf::Color(50, 100, 50));
+                LOG_WARN("Could not load ground3.png, using green placeholder");
+            }
+            else {
+                LOG_INFO("Background texture loaded successfully");
+            }
+        }, [this] {
+            backgroundTexture.loadFromImage(backgroundImage);
+            backgroundImage = sf::Image();
+        });
+    }
+
+    GameArt art() const {
+        GameArt art;
+        art.player = atlas.art("player");
+        art.enemy1 = atlas.art("enemy1");
+        art.enemy2 = atlas.art("enemy2");
+        art.health = atlas.art("health");
+        art.speed = atlas.art("speed");
+        art.floor = atlas.art("floor");
+        art.wall = atlas.art("wall");
+        art.destructible = atlas.art("destructible");
+        return art;
+    }
+
+private:
+    // An atlas image, or a solid placeholder if its file is missing
+    struct AtlasImage {
+        std::string name;
+        std::string filename;
+        sf::Vector2u placeholderSize;
+        sf::Color placeholder;
+        const char* placeholderName;
+        const char* loadedMessage;
+        sf::Image image;
+
+        void decode(const AssetArchive& archive) {
+            if (!archive.loadImage(image, filename) && !image.loadFromFile(filename)) {
+                image.create(placeholderSize.x, placeholderSize.y, placeholder);
+                LOG_WARN("Could not load %s, using %s placeholder", filename.c_str(), placeholderName);
+            }
+            else {
+                LOG_INFO("%s", loadedMessage);
+            }
+        }
+    };
+
+    std::vector<AtlasImage> images;
+    std::atomic<size_t> imagesDecoded{ 0 };
+    size_t imagesUploaded = 0;
+    unsigned maxAtlasSize = 0;
+    sf::Image backgroundImage;
+
+    void addImage(const std::string& name, const std::string& filename, unsigned width, unsigned height,
+        sf::Color placeholder, const char* placeholderName, const char* loadedMessage) {
+        images.push_back(AtlasImage{ name, filename, sf::Vector2u(width, height), placeholder, placeholderName, loadedMessage, sf::Image() });
+    }
+
+    // Runs on the loader thread that decodes the last atlas image. Images
+    // go in in the order they were added, so the layout does not depend on
+    // thread timing.
+    void packAtlas() {
+        for (const AtlasImage& image : images) {
+            atlas.add(image.name, image.image);
+        }
+        atlas.pack(maxAtlasSize);
+    }
+
+    // Every atlas image has been decoded, and so packed, by the time the
+    // last of their uploads runs
+    void uploadAtlasImage() {
+        if (++imagesUploaded < images.size()) return;
+        atlas.upload();
+        images.clear();
+    }
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Entities.hpp"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Tile kinds, in the order TileMap::setArt takes their art
+enum TileType {
+    TILE_EMPTY,       // nothing drawn, the background shows through
+    TILE_FLOOR,
+    TILE_WALL,
+    TILE_DESTRUCTIBLE, // solid until a bullet breaks it
+    TILE_TYPE_COUNT
+};
+
+// Level geometry on a grid of 32 px tiles. Levels are plain text, one
+// character per tile and one line per row:
+//
+//     .  empty      _  floor      #  wall      %  destructible
+//
+// Tiles are drawn from vertex arrays prebuilt per 16x16-tile chunk. Only
+// chunks that overlap the visible area are drawn, and a chunk's vertices
+// are only rebuilt after one of its tiles has changed.
+class TileMap {
+public:
+    static const int tileSize = 32;
+    static const int chunkTiles = 16;
+
+    void setArt(const SpriteArt& floor, const SpriteArt& wall, const SpriteArt& destructible) {
+        texture = wall.texture;
+        art[TILE_FLOOR] = floor.rect;
+        art[TILE_WALL] = wall.rect;
+        art[TILE_DESTRUCTIBLE] = destructible.rect;
+        markAllDirty();
+    }
+
+    bool loadFromFile(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file) return false;
+        std::stringstream text;
+        text << file.rdbuf();
+        return loadFromString(text.str());
+    }
+
+    // Returns false on an unknown character; short rows are padded with empty tiles
+    bool loadFromString(const std::string& text) {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        std::string line;
+        size_t width = 0;
+        while (std::getline(stream, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            width = std::max(width, line.size());
+            lines.push_back(line);
+        }
+
+        resize(static_cast<int>(width), static_cast<int>(lines.size()));
+        for (int row = 0; row < rows; row++) {
+            for (size_t column = 0; column < lines[row].size(); column++) {
+                TileType type;
+                switch (lines[row][column]) {
+                case '.': type = TILE_EMPTY; break;
+                case '_': type = TILE_FLOOR; break;
+                case '#': type = TILE_WALL; break;
+                case '%': type = TILE_DESTRUCTIBLE; break;
+                default:
+                    resize(0, 0);
+                    return false;
+                }
+                tiles[tileIndex(static_cast<int>(column), row)] = static_cast<sf::Uint8>(type);
+            }
+        }
+        initialTiles = tiles;
+        return true;
+    }
+
+    // Puts back every tile changed since the level was loaded
+    void reset() {
+        for (int row = 0; row < rows; row++) {
+            for (int column = 0; column < columns; column++) {
+                int index = tileIndex(column, row);
+                if (tiles[index] != initialTiles[index]) {
+                    setTile(column, row, static_cast<TileType>(initialTiles[index]));
+                }
+            }
+        }
+    }
+
+    int columnCount() const { return columns; }
+    int rowCount() const { return rows; }
+    bool empty() const { return tiles.empty(); }
+
+    TileType getTile(int column, int row) const {
+        if (column < 0 || column >= columns || row < 0 || row >= rows) return TILE_EMPTY;
+        return static_cast<TileType>(tiles[tileIndex(column, row)]);
+    }
+
+    void setTile(int column, int row, TileType type) {
+        if (column < 0 || column >= columns || row < 0 || row >= rows) return;
+        tiles[tileIndex(column, row)] = static_cast<sf::Uint8>(type);
+        chunks[chunkIndex(column / chunkTiles, row / chunkTiles)].dirty = true;
+    }
+
+    static bool isSolidType(TileType type) {
+        return type == TILE_WALL || type == TILE_DESTRUCTIBLE;
+    }
+
+    bool isSolid(int column, int row) const {
+        return isSolidType(getTile(column, row));
+    }
+
+    bool isSolidAt(sf::Vector2f position) const {
+        if (tiles.empty()) return false;
+        return isSolid(static_cast<int>(std::floor(position.x / tileSize)), static_cast<int>(std::floor(position.y / tileSize)));
+    }
+
+    // Whether any solid tile overlaps area; only the tiles under it are read
+    bool overlapsSolid(const sf::FloatRect& area) const {
+        if (tiles.empty()) return false;
+        int minColumn = static_cast<int>(std::floor(area.left / tileSize));
+        int maxColumn = static_cast<int>(std::floor((area.left + area.width) / tileSize));
+        int minRow = static_cast<int>(std::floor(area.top / tileSize));
+        int maxRow = static_cast<int>(std::floor((area.top + area.height) / tileSize));
+        for (int row = minRow; row <= maxRow; row++) {
+            for (int column = minColumn; column <= maxColumn; column++) {
+                if (isSolid(column, row)) return true;
+            }
+        }
+        return false;
+    }
+
+    // Draws the chunks overlapping visibleArea, rebuilding any that changed
+    void draw(sf::RenderTarget& target, const sf::FloatRect& visibleArea) {
+        drawCalls = 0;
+        if (tiles.empty()) return;
+        const float chunkSize = static_cast<float>(tileSize * chunkTiles);
+        int minChunkX = std::max(0, static_cast<int>(std::floor(visibleArea.left / chunkSize)));
+        int maxChunkX = std::min(chunkColumns - 1, static_cast<int>(std::floor((visibleArea.left + visibleArea.width) / chunkSize)));
+        int minChunkY = std::max(0, static_cast<int>(std::floor(visibleArea.top / chunkSize)));
+        int maxChunkY = std::min(chunkRows - 1, static_cast<int>(std::floor((visibleArea.top + visibleArea.height) / chunkSize)));
+
+        sf::RenderStates states;
+        states.texture = texture;
+        for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+            for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+                Chunk& chunk = chunks[chunkIndex(chunkX, chunkY)];
+                if (chunk.dirty) buildChunk(chunkX, chunkY);
+                if (chunk.vertices.getVertexCount() == 0) continue;
+                target.draw(chunk.vertices, states);
+                drawCalls++;
+            }
+        }
+    }
+
+    int drawCalls = 0;     // chunks drawn by the last draw()
+    int chunkRebuilds = 0; // chunk vertex arrays rebuilt so far
+
+private:
+    struct Chunk {
+        sf::VertexArray vertices{ sf::Triangles };
+        bool dirty = true;
+    };
+
+    int columns = 0;
+    int rows = 0;
+    int chunkColumns = 0;
+    int chunkRows = 0;
+    std::vector<sf::Uint8> tiles;
+    std::vector<sf::Uint8> initialTiles;
+    std::vector<Chunk> chunks;
+    const sf::Texture* texture = nullptr;
+    sf::IntRect art[TILE_TYPE_COUNT];
+
+    void resize(int newColumns, int newRows) {
+        columns = newColumns;
+        rows = newRows;
+        chunkColumns = (columns + chunkTiles - 1) / chunkTiles;
+        chunkRows = (rows + chunkTiles - 1) / chunkTiles;
+        tiles.assign(columns * rows, TILE_EMPTY);
+        initialTiles = tiles;
+        chunks.assign(chunkColumns * chunkRows, Chunk());
+    }
+
+    void markAllDirty() {
+        for (auto& chunk : chunks) chunk.dirty = true;
+    }
+
+    int tileIndex(int column, int row) const {
+        return row * columns + column;
+    }
+
+    int chunkIndex(int chunkX, int chunkY) const {
+        return chunkY * chunkColumns + chunkX;
+    }
+
+    void buildChunk(int chunkX, int chunkY) {
+        Chunk& chunk = chunks[chunkIndex(chunkX, chunkY)];
+        chunk.vertices.clear();
+        int lastColumn = std::min(columns, (chunkX + 1) * chunkTiles);
+        int lastRow = std::min(rows, (chunkY + 1) * chunkTiles);
+        for (int row = chunkY * chunkTiles; row < lastRow; row++) {
+            for (int column = chunkX * chunkTiles; column < lastColumn; column++) {
+                TileType type = getTile(column, row);
+                if (type == TILE_EMPTY) continue;
+                const sf::IntRect& rect = art[type];
+                float left = static_cast<float>(column * tileSize);
+                float top = static_cast<float>(row * tileSize);
+                float u0 = static_cast<float>(rect.left), v0 = static_cast<float>(rect.top);
+                float u1 = u0 + rect.width, v1 = v0 + rect.height;
+                sf::Vertex topLeft(sf::Vector2f(left, top), sf::Vector2f(u0, v0));
+                sf::Vertex topRight(sf::Vector2f(left + tileSize, top), sf::Vector2f(u1, v0));
+                sf::Vertex bottomLeft(sf::Vector2f(left, top + tileSize), sf::Vector2f(u0, v1));
+                sf::Vertex bottomRight(sf::Vector2f(left + tileSize, top + tileSize), sf::Vector2f(u1, v1));
+                chunk.vertices.append(topLeft);
+                chunk.vertices.append(topRight);
+                chunk.vertices.append(bottomLeft);
+                chunk.vertices.append(bottomLeft);
+                chunk.vertices.append(topRight);
+                chunk.vertices.append(bottomRight);
+            }
+        }
+        chunk.dirty = false;
+        chunkRebuilds++;
+    }
+};
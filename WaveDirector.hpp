@@ -0,0 +1,265 @@
+#pragma once
+
+#include "Entities.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// How a wave's zombies are spread over its duration
+enum WaveRamp {
+    RAMP_FLAT,     // evenly
+    RAMP_EASE_IN,  // few at first, most near the end
+    RAMP_EASE_OUT, // most at the start, tailing off
+    RAMP_BURST     // all at once, as fast as the spawn budget allows
+};
+
+// One wave of the config file
+struct WaveConfig {
+    int count = 20;
+    float duration = 10.0f; // seconds over which the wave arrives
+    float pause = 5.0f;     // seconds after that before the next wave starts
+    WaveRamp ramp = RAMP_FLAT;
+    float typeWeights[2] = { 60, 40 };     // ENEMY_TYPE_1, ENEMY_TYPE_2
+    float edgeWeights[4] = { 1, 1, 1, 1 }; // top, right, bottom, left
+};
+
+// Decides when zombies spawn, where on the arena edge and of which type.
+// Without a config it trickles them in as the game always has: the World
+// spawns one every enemySpawnDelay, on any edge, 60% of them type 1. With
+// one, zombies come in waves:
+//
+//     # comments run to the end of the line
+//     budget 16   most zombies spawned in one tick
+//     growth 1.5  wave counts multiply by this each time the list starts over
+//     wave count=40 time=10 ramp=flat types=60,40 edges=1,1,1,1 pause=5
+//     wave count=300 time=0 ramp=burst edges=1,0,0,1
+//
+// A wave line gives any of its keys; the others keep the defaults above.
+// Ramps are flat, ease-in, ease-out and burst. After the last wave the
+// list starts over with bigger counts.
+//
+// A wave's zombies fall due along its ramp, but at most the budget of them
+// spawn in one tick, so a burst of hundreds arrives over a few ticks
+// instead of stalling one. The distributions that pick edges, positions
+// and types are built when the config or the arena size changes, never
+// per spawn.
+class WaveDirector {
+public:
+    int spawnBudget = 16;
+    float growth = 1.5f;
+
+    WaveDirector() {
+        setArenaSize(arenaSize);
+    }
+
+    bool loadFromFile(const std::string& filename) {
+        std::ifstream file(filename);
+        if (!file) return false;
+        std::stringstream text;
+        text << file.rdbuf();
+        return loadFromString(text.str());
+    }
+
+    // Returns false on a line it does not understand, keeping the waves it had
+    bool loadFromString(const std::string& text) {
+        std::vector<WaveConfig> newWaves;
+        int newBudget = 16;
+        float newGrowth = 1.5f;
+        std::istringstream stream(text);
+        std::string line;
+        while (std::getline(stream, line)) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream words(line);
+            std::string keyword;
+            if (!(words >> keyword)) continue;
+            if (keyword == "budget") {
+                if (!(words >> newBudget) || newBudget < 1) return false;
+            }
+            else if (keyword == "growth") {
+                if (!(words >> newGrowth) || newGrowth <= 0) return false;
+            }
+            else if (keyword == "wave") {
+                WaveConfig wave;
+                std::string setting;
+                while (words >> setting) {
+                    if (!parseWaveSetting(setting, wave)) return false;
+                }
+                newWaves.push_back(wave);
+            }
+            else {
+                return false;
+            }
+        }
+
+        waves = newWaves;
+        spawnBudget = newBudget;
+        growth = newGrowth;
+        edgeDists.clear();
+        typeDists.clear();
+        for (const WaveConfig& wave : waves) {
+            edgeDists.emplace_back(wave.edgeWeights, wave.edgeWeights + 4);
+            typeDists.emplace_back(wave.typeWeights, wave.typeWeights + 2);
+        }
+        reset();
+        return true;
+    }
+
+    bool empty() const {
+        return waves.empty();
+    }
+
+    void setArenaSize(sf::Vector2f size) {
+        arenaSize = size;
+        xDist = std::uniform_real_distribution<float>(0, size.x);
+        yDist = std::uniform_real_distribution<float>(0, size.y);
+    }
+
+    // Back to the first wave, for a new round
+    void reset() {
+        current = 0;
+        cycle = 0;
+        elapsed = 0;
+        spawnedInWave = 0;
+        waveSize = waves.empty() ? 0 : scaledCount(waves[0]);
+        wavesStarted = waves.empty() ? 0 : 1;
+    }
+
+    // Advances the wave clock and returns how many zombies are due this
+    // tick, never more than the budget. Report the ones actually spawned
+    // with spawned(); the rest stay due.
+    int update(float deltaTime) {
+        if (waves.empty()) return 0;
+        elapsed += deltaTime;
+        const WaveConfig* wave = &waves[current];
+        if (spawnedInWave >= waveSize && elapsed >= wave->duration + wave->pause) {
+            startNextWave();
+            wave = &waves[current];
+        }
+        float progress = wave->duration > 0 ? std::min(1.0f, elapsed / wave->duration) : 1.0f;
+        int target = static_cast<int>(waveSize * rampFraction(wave->ramp, progress));
+        return std::max(0, std::min(spawnBudget, target - spawnedInWave));
+    }
+
+    void spawned(int count) {
+        spawnedInWave += count;
+    }
+
+    // A point on the arena edge, the edge picked by the current wave's bias
+    sf::Vector2f pickSpawnPoint(std::mt19937& rng) {
+        int edge = waves.empty() ? anyEdge(rng) : edgeDists[current](rng);
+        switch (edge) {
+        case 0: return sf::Vector2f(xDist(rng), 0); // Top
+        case 1: return sf::Vector2f(arenaSize.x, yDist(rng)); // Right
+        case 2: return sf::Vector2f(xDist(rng), arenaSize.y); // Bottom
+        default: return sf::Vector2f(0, yDist(rng)); // Left
+        }
+    }
+
+    EnemyType pickType(std::mt19937& rng) {
+        if (waves.empty()) return percent(rng) < 60 ? ENEMY_TYPE_1 : ENEMY_TYPE_2;
+        return typeDists[current](rng) == 0 ? ENEMY_TYPE_1 : ENEMY_TYPE_2;
+    }
+
+    // Waves started this round, counting the one under way
+    int waveNumber() const {
+        return wavesStarted;
+    }
+
+    int waveCount() const {
+        return static_cast<int>(waves.size());
+    }
+
+private:
+    std::vector<WaveConfig> waves;
+    std::vector<std::discrete_distribution<int>> edgeDists; // per wave
+    std::vector<std::discrete_distribution<int>> typeDists; // per wave
+    std::uniform_int_distribution<int> anyEdge = std::uniform_int_distribution<int>(0, 3);
+    std::uniform_int_distribution<int> percent = std::uniform_int_distribution<int>(0, 99);
+    std::uniform_real_distribution<float> xDist;
+    std::uniform_real_distribution<float> yDist;
+    sf::Vector2f arenaSize = sf::Vector2f(1600, 900);
+
+    int current = 0;       // index into waves
+    int cycle = 0;         // times the list has started over
+    float elapsed = 0;     // seconds since the current wave started
+    int spawnedInWave = 0;
+    int waveSize = 0;      // the current wave's count, grown for the cycle
+    int wavesStarted = 0;
+
+    void startNextWave() {
+        current++;
+        if (current == static_cast<int>(waves.size())) {
+            current = 0;
+            cycle++;
+        }
+        elapsed = 0;
+        spawnedInWave = 0;
+        waveSize = scaledCount(waves[current]);
+        wavesStarted++;
+    }
+
+    int scaledCount(const WaveConfig& wave) const {
+        double count = wave.count * std::pow(static_cast<double>(growth), cycle);
+        return static_cast<int>(std::min(count + 0.5, 1000000.0));
+    }
+
+    // Fraction of the wave due once `progress` of its duration has passed
+    static float rampFraction(WaveRamp ramp, float progress) {
+        switch (ramp) {
+        case RAMP_EASE_IN: return progress * progress;
+        case RAMP_EASE_OUT: return 1 - (1 - progress) * (1 - progress);
+        case RAMP_BURST: return 1;
+        default: return progress;
+        }
+    }
+
+    static bool parseWaveSetting(const std::string& setting, WaveConfig& wave) {
+        size_t equals = setting.find('=');
+        if (equals == std::string::npos) return false;
+        std::string key = setting.substr(0, equals);
+        const char* value = setting.c_str() + equals + 1;
+        char end;
+        if (key == "count") {
+            return std::sscanf(value, "%d%c", &wave.count, &end) == 1 && wave.count >= 0;
+        }
+        if (key == "time") {
+            return std::sscanf(value, "%f%c", &wave.duration, &end) == 1 && wave.duration >= 0;
+        }
+        if (key == "pause") {
+            return std::sscanf(value, "%f%c", &wave.pause, &end) == 1 && wave.pause >= 0;
+        }
+        if (key == "ramp") {
+            std::string name = value;
+            if (name == "flat") wave.ramp = RAMP_FLAT;
+            else if (name == "ease-in") wave.ramp = RAMP_EASE_IN;
+            else if (name == "ease-out") wave.ramp = RAMP_EASE_OUT;
+            else if (name == "burst") wave.ramp = RAMP_BURST;
+            else return false;
+            return true;
+        }
+        if (key == "types") {
+            float* w = wave.typeWeights;
+            return std::sscanf(value, "%f,%f%c", &w[0], &w[1], &end) == 2 && validWeights(w, 2);
+        }
+        if (key == "edges") {
+            float* w = wave.edgeWeights;
+            return std::sscanf(value, "%f,%f,%f,%f%c", &w[0], &w[1], &w[2], &w[3], &end) == 4 && validWeights(w, 4);
+        }
+        return false;
+    }
+
+    // Weights are relative; at least one must be positive
+    static bool validWeights(const float* weights, int count) {
+        float total = 0;
+        for (int i = 0; i < count; i++) {
+            if (weights[i] < 0) return false;
+            total += weights[i];
+        }
+        return total > 0;
+    }
+};
@@ -0,0 +1,549 @@
+#pragma once
+
+#include "Entities.hpp"
+#include "Components.hpp"
+#include "EnemyStore.hpp"
+#include "BulletStore.hpp"
+#include "PowerupStore.hpp"
+#include "SpatialHash.hpp"
+#include "FlowField.hpp"
+#include "TileMap.hpp"
+#include "Profiler.hpp"
+#include "JobSystem.hpp"
+#include "WaveDirector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Length of one simulation step. The game runs the simulation at this fixed
+// rate whatever the frame rate, and so do headless runs.
+const float SIMULATION_STEP = 1.0f / 120.0f;
+
+// What the player asked for this tick, already translated from the
+// keyboard and mouse (or from a script when running headless)
+struct PlayerInput {
+    sf::Vector2f movement;  // WASD axes, each -1, 0 or 1
+    sf::Vector2f aimTarget; // world position the player faces and shoots at
+    int shots = 0;          // bullets fired this tick
+};
+
+// What happened during a tick, so the caller can play sounds
+struct TickEvents {
+    enum { maxKillPositions = 8 };
+
+    int shotsFired = 0;
+    int enemiesKilled = 0;
+    sf::Vector2f killPositions[maxKillPositions]; // where the first kills happened
+    int playerHits = 0;
+    int powerupsCollected = 0;
+};
+
+// Every archetype the simulation has, one table each
+typedef Registry<PlayerTable, EnemyStore, BulletStore, PowerupStore> EntityRegistry;
+
+// The simulation: player movement, spawning, entity updates and collision.
+// It never touches a window, so it can be stepped on machines without a
+// display.
+class World {
+public:
+    GameArt art;
+    std::mt19937 rng;
+    GameState state;
+
+    // Every entity lives in the registry; the references name its tables
+    EntityRegistry entities;
+    Player& player;
+    EnemyStore& enemies;
+    BulletStore& bullets;
+    PowerupStore& powerups;
+    SpatialHash enemyGrid;
+    FlowField flowField; // routes enemies around blocked cells, once there are any
+    TileMap tiles;       // level geometry; empty for the open arena
+    WaveDirector waves;  // when, where and what zombies spawn; trickles them in without a config
+    JobSystem* jobs = &JobSystem::shared(); // threads for the per-tick sweeps
+
+    int totalEnemiesClassic = 30;
+    int enemiesKilled = 0;
+    float enemySpawnTimer = 0;
+    float enemySpawnDelay = 1.5f; // between zombies when there are no waves
+    float powerupSpawnTimer = 0;
+    float powerupSpawnDelay = 7.0f;
+    float bulletSpeed = 600.0f; // px/s; bullets are swept, so any speed hits what it passes
+    // Push zombies apart so a horde spreads round its target (see
+    // EnemyStore::separate). Off by default: with 50k zombies it costs ten
+    // times the rest of the tick. The window turns it on.
+    bool crowdSeparation = false;
+
+    float timeTrialDuration = 60.0f;
+    float timeTrialTimer = timeTrialDuration;
+    int timeTrialKills = 0;
+    int xpEarned = 0;
+    int enemiesSpawned = 0; // this round
+
+    // The player's collision proxy, since the World was made: sprite
+    // transforms worked out to refresh it, and reads of it where a
+    // getBounds() or getCenter() call used to work one out. Enemies,
+    // bullets and powerups keep plain positions and bounds, so reading
+    // them never replaced a transform and is not counted
+    long long transformsEvaluated = 0;
+    long long proxyReads = 0;
+
+    World(const GameArt& gameArt, unsigned seed)
+        : art(gameArt), rng(seed), state(MAIN_MENU), player(createPlayer()),
+          enemies(entities.table<EnemyStore>()), bullets(entities.table<BulletStore>()),
+          powerups(entities.table<PowerupStore>()) {
+        enemies.setArt(art.enemy1, art.enemy2);
+        powerups.setArt(art.health, art.speed);
+        tiles.setArt(art.floor, art.wall, art.destructible);
+        enemies.reserve(50); // Reserve space to prevent reallocations
+        powerups.reserve(10);
+        bulletHits.reserve(bullets.capacity());
+        entities.reserve(bullets.capacity() + 256); // handles, so firing never grows the registry
+    }
+
+    // The references above point into the registry
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    void start(GameState mode) {
+        state = mode;
+        player.reset(800, 450);
+        entities.clear<BulletStore>();
+        entities.clear<EnemyStore>();
+        enemyGrid.clear();
+        entities.clear<PowerupStore>();
+        enemiesKilled = 0;
+        timeTrialTimer = timeTrialDuration;
+        timeTrialKills = 0;
+        xpEarned = 0;
+        enemiesSpawned = 0;
+        enemySpawnTimer = 0;
+        powerupSpawnTimer = 0;
+        waves.reset();
+        tiles.reset();
+        blockSolidTiles();
+    }
+
+    // Starts a round from a known random state, so the same inputs play it
+    // out the same way every time (see Replay.hpp)
+    void start(GameState mode, unsigned seed) {
+        rng.seed(seed);
+        start(mode);
+    }
+
+    // Loads level geometry; walls then block the player, bullets and
+    // enemies, which path around them along the flow field
+    bool loadLevel(const std::string& filename) {
+        if (!tiles.loadFromFile(filename)) return false;
+        setArenaSize(std::max(arenaSize.x, static_cast<float>(tiles.columnCount() * TileMap::tileSize)),
+            std::max(arenaSize.y, static_cast<float>(tiles.rowCount() * TileMap::tileSize)));
+        return true;
+    }
+
+    // Spawns zombies in the waves described by a config file (see
+    // WaveDirector.hpp) instead of one every enemySpawnDelay
+    bool loadWaves(const std::string& filename) {
+        return waves.loadFromFile(filename);
+    }
+
+    // The playable area runs from (0, 0) to arenaSize and may be larger
+    // than the screen, but never smaller
+    void setArenaSize(float width, float height) {
+        arenaSize = sf::Vector2f(std::max(1600.0f, width), std::max(900.0f, height));
+        enemyGrid.resize(arenaSize.x, arenaSize.y, 64);
+        waves.setArenaSize(arenaSize);
+        flowField.resize(arenaSize.x, arenaSize.y, static_cast<float>(TileMap::tileSize));
+        blockSolidTiles();
+    }
+
+    sf::Vector2f getArenaSize() const {
+        return arenaSize;
+    }
+
+    long long transformsSaved() const {
+        return proxyReads - transformsEvaluated;
+    }
+
+    bool isPlaying() const {
+        return state == PLAYING_CLASSIC || state == PLAYING_TIME_TRIAL;
+    }
+
+    GameState step(float deltaTime, const PlayerInput& input, TickEvents& events) {
+        if (!isPlaying()) return state;
+
+        player.previousPosition = player.sprite.getPosition();
+        entities.each<POSITION_X, POSITION_Y, PREVIOUS_X, PREVIOUS_Y>(
+            [](float x, float y, float& previousX, float& previousY) {
+                previousX = x;
+                previousY = y;
+            });
+
+        {
+            PROFILE_SCOPE(PROFILE_MOVEMENT);
+            // The player's proxy is still the one from the end of the last tick
+            proxyReads += std::max(0, input.shots);
+            for (int i = 0; i < input.shots; i++) {
+                sf::Vector2f playerCenter = player.proxy.center;
+                sf::Vector2f direction = normalize(input.aimTarget - playerCenter);
+                Entity shot = entities.add<BulletStore>([&](Entity entity) {
+                    return bullets.spawn(playerCenter.x, playerCenter.y, direction, bulletSpeed, entity);
+                });
+                if (!shot.isNull()) {
+                    events.shotsFired++;
+                }
+            }
+
+            sf::Vector2f movement = input.movement;
+            if (movement.x != 0 || movement.y != 0) {
+                movement = normalize(movement);
+            }
+
+            movePlayer(movement * player.speed * deltaTime);
+            player.update(deltaTime);
+
+            // From here on every pass reads the proxy rather than the sprite
+            player.refreshProxy();
+            transformsEvaluated++;
+            if (player.rotateTowards(input.aimTarget)) {
+                player.refreshProxy();
+                transformsEvaluated++;
+            }
+            proxyReads += 2;
+
+            bullets.update(deltaTime, arenaSize, *jobs);
+            entities.compact<BulletStore>();
+            stopBulletsAtWalls();
+        }
+
+        {
+            PROFILE_SCOPE(PROFILE_SPAWNING);
+            int classicLeft = totalEnemiesClassic - enemies.count() - enemiesKilled;
+            int spawnCount = 0;
+            if (waves.empty()) {
+                enemySpawnTimer += deltaTime;
+                bool shouldSpawnEnemy = false;
+                if (state == PLAYING_CLASSIC) {
+                    shouldSpawnEnemy = (enemySpawnTimer >= enemySpawnDelay && classicLeft > 0);
+                }
+                else {
+                    shouldSpawnEnemy = (enemySpawnTimer >= enemySpawnDelay);
+                }
+                if (shouldSpawnEnemy) {
+                    enemySpawnTimer = 0;
+                    spawnCount = 1;
+                }
+            }
+            else {
+                spawnCount = waves.update(deltaTime);
+                if (state == PLAYING_CLASSIC) {
+                    spawnCount = std::min(spawnCount, std::max(0, classicLeft));
+                }
+                waves.spawned(spawnCount);
+            }
+
+            for (int i = 0; i < spawnCount; i++) {
+                sf::Vector2f spawnPoint = waves.pickSpawnPoint(rng);
+                EnemyType enemyType = waves.pickType(rng);
+                entities.add<EnemyStore>([&](Entity entity) {
+                    return enemies.spawn(spawnPoint.x, spawnPoint.y, enemyType, rng, entity);
+                });
+            }
+            enemiesSpawned += spawnCount;
+
+            powerupSpawnTimer += deltaTime;
+            if (powerupSpawnTimer >= powerupSpawnDelay) {
+                powerupSpawnTimer = 0;
+                std::uniform_real_distribution<float> xDist(100, arenaSize.x - 100);
+                std::uniform_real_distribution<float> yDist(100, arenaSize.y - 100);
+                PowerupType powerupType = (std::uniform_int_distribution<int>(0, 1)(rng) == 0) ? HEALTH_BOOST : SPEED_BOOST;
+                float x = xDist(rng);
+                float y = yDist(rng);
+                entities.add<PowerupStore>([&](Entity entity) {
+                    return powerups.spawn(x, y, powerupType, entity);
+                });
+            }
+        }
+
+        {
+            PROFILE_SCOPE(PROFILE_MOVEMENT);
+            // The grid is still the one built in the last tick's collision
+            // pass, which holds every enemy but this tick's spawns where
+            // they are
+            if (crowdSeparation) {
+                enemies.separate(deltaTime, enemyGrid, *jobs);
+            }
+            sf::Vector2f playerCenter = player.proxy.center;
+            proxyReads++;
+            if (flowField.hasObstacles()) {
+                flowField.update(playerCenter);
+                enemies.followFlow(deltaTime, playerCenter, flowField, *jobs);
+            }
+            else {
+                enemies.update(deltaTime, playerCenter, *jobs);
+            }
+            if (!tiles.empty()) {
+                enemies.blockBy(tiles, *jobs);
+            }
+        }
+
+        {
+            PROFILE_SCOPE(PROFILE_COLLISION);
+            // Damage only ever adds up, so summing it per chunk and applying
+            // it once leaves the same health as applying it enemy by enemy
+            sf::FloatRect playerBounds = player.proxy.bounds;
+            proxyReads++;
+            std::atomic<int> damageTaken(0), hits(0);
+            jobs->parallelFor(enemies.count(), 4096, [&](int begin, int end) {
+                int chunkDamage = 0, chunkHits = 0;
+                for (int i = begin; i < end; i++) {
+                    if (enemies.active[i] && checkCollision(enemies.getBounds(i), playerBounds)) {
+                        chunkDamage += enemies.damage[i];
+                        chunkHits++;
+                        enemies.active[i] = 0;
+                    }
+                }
+                damageTaken += chunkDamage;
+                hits += chunkHits;
+            });
+            if (hits > 0) {
+                player.takeDamage(damageTaken);
+                events.playerHits += hits;
+            }
+
+            // Powerup bounds come with the update, without a transform;
+            // the player's proxy is shared by every test
+            powerups.update(deltaTime);
+            for (int i = 0; i < powerups.count(); i++) {
+                if (checkCollision(powerups.bounds[i], playerBounds) && powerups.active[i]) {
+                    if (powerups.type[i] == HEALTH_BOOST && player.health < player.maxHealth) {
+                        player.heal(20);
+                    }
+                    else if (powerups.type[i] == SPEED_BOOST) {
+                        player.applySpeedBoost();
+                    }
+                    powerups.active[i] = 0;
+                    events.powerupsCollected++;
+                }
+            }
+
+            // Every bullet looks up its hit in parallel against this tick's
+            // enemies, along its whole move since the last tick so fast
+            // bullets cannot pass through a zombie; kills are then applied in
+            // firing order. If an earlier bullet already killed the enemy,
+            // the lookup is redone against the survivors, which is exactly
+            // what a serial pass would find.
+            enemyGrid.build(enemies.count(), [this](int i) { return enemies.getBounds(i); });
+            const int bulletCount = bullets.count();
+            bulletHits.resize(bulletCount);
+            jobs->parallelFor(bulletCount, 64, [&](int begin, int end) {
+                for (int k = begin; k < end; k++) {
+                    bulletHits[k] = findBulletHit(bullets, k);
+                }
+            });
+            for (int k = 0; k < bulletCount; k++) {
+                if (!bullets.active[k]) continue; // stopped by a wall this tick
+                int hit = bulletHits[k];
+                if (hit >= 0 && !enemies.active[hit]) {
+                    hit = findBulletHit(bullets, k);
+                }
+                if (hit >= 0) {
+                    bullets.active[k] = 0;
+                    enemies.active[hit] = 0;
+                    if (events.enemiesKilled < TickEvents::maxKillPositions) {
+                        events.killPositions[events.enemiesKilled] = enemies.getCenter(hit);
+                    }
+                    events.enemiesKilled++;
+                    if (state == PLAYING_CLASSIC) {
+                        enemiesKilled++;
+                    }
+                    else {
+                        timeTrialKills++;
+                    }
+                }
+            }
+        }
+
+        {
+            PROFILE_SCOPE(PROFILE_COMPACTION);
+            entities.compact<BulletStore>();
+            // The grid must keep matching enemy indices after the step:
+            // rendering culls against it and the next tick separates with
+            // it. Nothing has moved since it was built, so it is renumbered
+            // rather than built again.
+            std::vector<sf::Uint8>& alive = enemies.active;
+            if (std::find(alive.begin(), alive.end(), 0) != alive.end()) {
+                enemyGrid.compact([&alive](int i) { return alive[i] != 0; });
+                entities.compact<EnemyStore>();
+            }
+            entities.compact<PowerupStore>();
+        }
+
+        if (state == PLAYING_TIME_TRIAL) {
+            timeTrialTimer -= deltaTime;
+            if (timeTrialTimer <= 0) {
+                xpEarned = timeTrialKills * 10 + static_cast<int>(timeTrialDuration * 5);
+                state = TIME_TRIAL_RESULTS;
+            }
+        }
+
+        if (player.health <= 0) {
+            state = GAME_OVER;
+        }
+        else if (state == PLAYING_CLASSIC && enemiesKilled >= totalEnemiesClassic) {
+            state = VICTORY;
+        }
+
+        return state;
+    }
+
+    // Live enemy bullet b of the store touched first along its last move,
+    // or -1. The grid is queried with the bounds of the whole move, and only
+    // enemies overlapping those get the exact sweep test. Ties go to the
+    // lowest index, which keeps the result identical to testing every enemy
+    // in order.
+    int findBulletHit(const BulletStore& store, int b) const {
+        sf::FloatRect sweptBounds = store.getSweptBounds(b);
+        sf::Vector2f halfSize(BulletStore::radius, BulletStore::radius);
+        sf::Vector2f from = store.getPreviousPosition(b) + halfSize;
+        sf::Vector2f to = store.getPosition(b) + halfSize;
+        int hit = -1;
+        float hitTime = 0;
+        enemyGrid.query(sweptBounds, [&](int i) {
+            // Nothing beats a hit at the start of the move but a lower index
+            if (!enemies.active[i] || (hit >= 0 && hitTime == 0 && i > hit)) return;
+            sf::FloatRect enemyBounds = enemies.getBounds(i);
+            if (!checkCollision(sweptBounds, enemyBounds)) return;
+            float time = sweepCollision(from, to, halfSize, enemyBounds);
+            if (time >= 0 && (hit < 0 || time < hitTime || (time == hitTime && i < hit))) {
+                hit = i;
+                hitTime = time;
+            }
+        });
+        return hit;
+    }
+
+private:
+    sf::Vector2f arenaSize = sf::Vector2f(1600, 900);
+    std::vector<int> bulletHits; // per bullet row, filled by the parallel lookup
+
+    // Adds the player's single row, for the player reference to bind to
+    Player& createPlayer() {
+        Entity entity = entities.create<PlayerTable>();
+        Player& created = *entities.get<PLAYER>(entity);
+        created = Player(800, 450, art.player);
+        return created;
+    }
+
+    // Moves the player one axis at a time so it slides along walls, kept
+    // inside the arena. Each axis is clamped to the arena before the wall
+    // test, so the clamp can never put the footprint in a wall. A move is
+    // only refused if it would take the footprint from open ground into a
+    // wall, so a player placed inside one can still walk out.
+    void movePlayer(sf::Vector2f offset) {
+        // Moving does not change the size of the bounds, only turning does,
+        // and the sprite turns about its centre, so they stay centred on it
+        const sf::Vector2f half = player.proxy.halfSize;
+        const sf::Vector2f axes[2] = { sf::Vector2f(offset.x, 0), sf::Vector2f(0, offset.y) };
+        for (const auto& axis : axes) {
+            sf::Vector2f from = player.sprite.getPosition();
+            sf::Vector2f to = from + axis;
+            to.x = std::max(half.x, std::min(to.x, arenaSize.x - half.x));
+            to.y = std::max(half.y, std::min(to.y, arenaSize.y - half.y));
+            if (to == from) continue;
+            bool wasClear = !tiles.overlapsSolid(player.getFootprint());
+            player.sprite.setPosition(to);
+            if (wasClear && tiles.overlapsSolid(player.getFootprint())) {
+                player.sprite.setPosition(from);
+            }
+        }
+    }
+
+    // Bullets stop at the first solid tile along their move, and break
+    // destructible ones. The move is checked at points at most half a tile
+    // apart, so a fast bullet cannot pass through a wall either.
+    void stopBulletsAtWalls() {
+        if (tiles.empty()) return;
+        for (int b = 0; b < bullets.count(); b++) {
+            if (!bullets.active[b]) continue;
+            const float radius = BulletStore::radius;
+            sf::Vector2f from = bullets.getPreviousPosition(b) + sf::Vector2f(radius, radius);
+            sf::Vector2f to = bullets.getPosition(b) + sf::Vector2f(radius, radius);
+            int samples = std::max(1, static_cast<int>(std::ceil(distance(from, to) / (TileMap::tileSize / 2.0f))));
+            for (int sample = 1; sample <= samples; sample++) {
+                sf::Vector2f center = lerp(from, to, static_cast<float>(sample) / samples);
+                int column = static_cast<int>(std::floor(center.x / TileMap::tileSize));
+                int row = static_cast<int>(std::floor(center.y / TileMap::tileSize));
+                TileType tile = tiles.getTile(column, row);
+                if (!TileMap::isSolidType(tile)) continue;
+                bullets.active[b] = 0;
+                if (tile == TILE_DESTRUCTIBLE) {
+                    tiles.setTile(column, row, TILE_FLOOR);
+                    flowField.setBlocked(column, row, false);
+                }
+                break;
+            }
+        }
+    }
+
+    void blockSolidTiles() {
+        for (int row = 0; row < flowField.rowCount(); row++) {
+            for (int column = 0; column < flowField.columnCount(); column++) {
+                flowField.setBlocked(column, row, tiles.isSolid(column, row));
+            }
+        }
+    }
+};
+
+// Size of an image on disk without uploading it to the GPU, falling back to
+// the placeholder size the texture manager would use
+inline SpriteArt loadArtSize(const std::string& filename, int placeholderSize) {
+    SpriteArt art;
+    sf::Image img;
+    if (img.loadFromFile(filename)) {
+        art.rect = sf::IntRect(0, 0, img.getSize().x, img.getSize().y);
+    }
+    else {
+        art.rect = sf::IntRect(0, 0, placeholderSize, placeholderSize);
+    }
+    return art;
+}
+
+// Texture-less art for headless runs, sized like the real textures
+inline GameArt loadHeadlessArt() {
+    GameArt art;
+    art.player = loadArtSize("player.png", 50);
+    art.enemy1 = loadArtSize("enemy1.png", 40);
+    art.enemy2 = loadArtSize("enemy2.png", 40);
+    art.health = loadArtSize("health.png", 30);
+    art.speed = loadArtSize("speed.png", 30);
+    art.floor = loadArtSize("floor.png", 32);
+    art.wall = loadArtSize("wall.png", 32);
+    art.destructible = loadArtSize("destructible.png", 32);
+    return art;
+}
+
+// Scripted stand-in for the keyboard and mouse when there is no window:
+// circles the arena, faces the nearest zombie and fires six times a second
+inline PlayerInput autopilotInput(const World& world, int tick) {
+    PlayerInput input;
+    float angle = tick * 0.005f;
+    input.movement = sf::Vector2f(cos(angle), sin(angle));
+
+    sf::Vector2f playerCenter = world.player.proxy.center;
+    input.aimTarget = playerCenter + sf::Vector2f(1, 0);
+    float nearest = -1;
+    for (int i = 0; i < world.enemies.count(); i++) {
+        sf::Vector2f enemyCenter = world.enemies.getCenter(i);
+        float d = distance(playerCenter, enemyCenter);
+        if (nearest < 0 || d < nearest) {
+            nearest = d;
+            input.aimTarget = enemyCenter;
+        }
+    }
+
+    if (nearest >= 0 && tick % 20 == 0) {
+        input.shots = 1;
+    }
+    return input;
+}
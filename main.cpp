@@ -1,5 +1,20 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include "Entities.hpp"
+#define ALLOCATION_COUNTER_IMPLEMENTATION
+#include "AllocationCounter.hpp"
+#include "World.hpp"
+#include "Benchmarks.hpp"
+#include "SpriteBatch.hpp"
+#include "Log.hpp"
+#include "FixedTimestep.hpp"
+#include "TextureManager.hpp"
+#include "AssetLoader.hpp"
+#include "AssetArchive.hpp"
+#include "Profiler.hpp"
+#include "Hud.hpp"
+#include "SoundPool.hpp"
+#include "Replay.hpp"
 #include <vector>
 #include <cmath>
 #include <random>
@@ -7,321 +22,41 @@
 #include <sstream>
 #include <iomanip>
 #include <memory>
-
-// Game states
-enum GameState {
-    MAIN_MENU,
-    PLAYING_CLASSIC,
-    PLAYING_TIME_TRIAL,
-    GAME_OVER,
-    VICTORY,
-    TIME_TRIAL_RESULTS
-};
-
-// Powerup types
-enum PowerupType {
-    HEALTH_BOOST,
-    SPEED_BOOST
-};
-
-// Enemy types
-enum EnemyType {
-    ENEMY_TYPE_1,
-    ENEMY_TYPE_2
-};
-
-// Texture manager to hold shared textures
-class TextureManager {
-public:
-    sf::Texture playerTexture;
-    sf::Texture enemy1Texture;
-    sf::Texture enemy2Texture;
-    sf::Texture healthTexture;
-    sf::Texture speedTexture;
-    sf::Texture backgroundTexture;
-
-    TextureManager() {
-        // Load player texture
-        if (!playerTexture.loadFromFile("player.png")) {
-            sf::Image img;
-            img.create(50, 50, sf::Color::Blue);
-            playerTexture.loadFromImage(img);
-            std::cout << "Warning: Could not load player.png, using blue placeholder" << std::endl;
-        }
-        else {
-            std::cout << "Player texture loaded successfully" << std::endl;
-        }
-
-        // Load enemy1 texture
-        if (!enemy1Texture.loadFromFile("enemy1.png")) {
-            sf::Image img;
-            img.create(40, 40, sf::Color::Red);
-            enemy1Texture.loadFromImage(img);
-            std::cout << "Warning: Could not load enemy1.png, using red placeholder" << std::endl;
-        }
-        else {
-            std::cout << "Enemy1 texture loaded successfully" << std::endl;
-        }
-
-        // Load enemy2 texture
-        if (!enemy2Texture.loadFromFile("enemy2.png")) {
-            sf::Image img;
-            img.create(40, 40, sf::Color::Magenta);
-            enemy2Texture.loadFromImage(img);
-            std::cout << "Warning: Could not load enemy2.png, using magenta placeholder" << std::endl;
-        }
-        else {
-            std::cout << "Enemy2 texture loaded successfully" << std::endl;
-        }
-
-        // Load health powerup texture
-        if (!healthTexture.loadFromFile("health.png")) {
-            sf::Image img;
-            img.create(30, 30, sf::Color::Green);
-            healthTexture.loadFromImage(img);
-            std::cout << "Warning: Could not load health.png, using green placeholder" << std::endl;
-        }
-        else {
-            std::cout << "Health powerup texture loaded successfully" << std::endl;
-        }
-
-        // Load speed powerup texture
-        if (!speedTexture.loadFromFile("speed.png")) {
-            sf::Image img;
-            img.create(30, 30, sf::Color::Cyan);
-            speedTexture.loadFromImage(img);
-            std::cout << "Warning: Could not load speed.png, using cyan placeholder" << std::endl;
-        }
-        else {
-            std::cout << "Speed powerup texture loaded successfully" << std::endl;
-        }
-
-        // Load background texture
-        if (!backgroundTexture.loadFromFile("3858.jpg")) {
-
-            //if (!backgroundTexture.loadFromFile("ground3.png")) {
-            sf::Image img;
-            img.create(1600, 900, sf::Color(50, 100, 50));
-            backgroundTexture.loadFromImage(img);
-            std::cout << "Warning: Could not load ground3.png, using green placeholder" << std::endl;
-
-
-
-
-
-
-
-
-
-        }
-        else {
-            std::cout << "Background texture loaded successfully" << std::endl;
-        }
-    }
-};
-
-// Player class
-class Player {
-public:
-    sf::Sprite sprite;
-    float speed;
-    float baseSpeed;
-    int health;
-    int maxHealth;
-    float speedBoostTimer;
-    bool hasSpeedBoost;
-
-    Player(float x, float y, sf::Texture& texture) {
-        sprite.setTexture(texture);
-        sprite.setPosition(x, y);
-        sprite.setScale(0.4f, 0.4f); // Increased for visibility
-
-        baseSpeed = 300.0f;
-        speed = baseSpeed;
-        health = 100;
-        maxHealth = 100;
-        speedBoostTimer = 0;
-        hasSpeedBoost = false;
-    }
-
-    void reset(float x, float y) {
-        sprite.setPosition(x, y);
-        health = 100;
-        speed = baseSpeed;
-        speedBoostTimer = 0;
-        hasSpeedBoost = false;
-    }
-
-    void update(float deltaTime) {
-        if (hasSpeedBoost) {
-            speedBoostTimer -= deltaTime;
-            if (speedBoostTimer <= 0) {
-                hasSpeedBoost = false;
-                speed = baseSpeed;
-            }
-        }
-    }
-
-    void takeDamage(int damage) {
-        health -= damage;
-        if (health < 0) health = 0;
-    }
-
-    void heal(int amount) {
-        health += amount;
-        if (health > maxHealth) health = maxHealth;
-    }
-
-    void applySpeedBoost() {
-        hasSpeedBoost = true;
-        speed = baseSpeed * 1.5f;
-        speedBoostTimer = 5.0f;
-    }
-
-    sf::Vector2f getCenter() {
-        sf::FloatRect bounds = sprite.getGlobalBounds();
-        return sf::Vector2f(bounds.left + bounds.width / 2, bounds.top + bounds.height / 2);
-    }
-
-    sf::FloatRect getBounds() {
-        return sprite.getGlobalBounds();
-    }
-    void rotateTowards(sf::Vector2f targetPos) {
-        sf::Vector2f playerCenter = getCenter();
-        sf::Vector2f direction = targetPos - playerCenter;
-
-        // Calculate distance to mouse
-        float distance = sqrt(direction.x * direction.x + direction.y * direction.y);
-
-        // Only rotate if mouse is far enough away (dead zone)
-        if (distance > 30.0f) {  // 30 pixel dead zone - adjust this value as needed
-            // Calculate angle in degrees
-            float angle = atan2(direction.y, direction.x) * 180.0f / 3.14159f;
-
-            // Set the rotation
-            sprite.setRotation(angle);
-        }
-    }
-    
-
-
-};
-
-// Bullet class
-class Bullet {
-public:
-    sf::CircleShape shape;
-    sf::Vector2f velocity;
-    bool active;
-
-    Bullet(float x, float y, sf::Vector2f direction) {
-        shape.setRadius(4);
-        shape.setFillColor(sf::Color::Yellow);
-        shape.setPosition(x - 4, y - 4);
-
-
-        float speed = 600.0f;
-        velocity = direction * speed;
-        active = true;
-    }
-
-    void update(float deltaTime) {
-        if (active) {
-            shape.move(velocity * deltaTime);
-            sf::Vector2f pos = shape.getPosition();
-            if (pos.x < 0 || pos.x > 1600 || pos.y < 0 || pos.y > 900) {
-                active = false;
-            }
-        }
-    }
-
-    sf::FloatRect getBounds() {
-        return shape.getGlobalBounds();
-    }
-};
-
-// Enemy class
-class Enemy {
-public:
-    sf::Sprite sprite;
-    float speed;
-    bool active;
-    EnemyType type;
-    int damage;
-
-    Enemy(float x, float y, EnemyType enemyType, sf::Texture& texture, std::mt19937& rng) {
-        type = enemyType;
-        active = true;
-
-        sprite.setTexture(texture);
-        sprite.setPosition(x, y);
-        sprite.setScale(0.25f, 0.25f); // Increased for visibility
-
-        if (type == ENEMY_TYPE_1) {
-            std::uniform_real_distribution<float> speedDist(80.0f, 120.0f);
-            speed = speedDist(rng);
-            damage = 15;
-        }
-        else {
-            std::uniform_real_distribution<float> speedDist(120.0f, 180.0f);
-            speed = speedDist(rng);
-            damage = 30;
-        }
-    }
-
-    void update(float deltaTime, sf::Vector2f playerPos) {
-        if (active) {
-            sf::Vector2f enemyCenter = getCenter();
-            sf::Vector2f direction = playerPos - enemyCenter;
-            float length = sqrt(direction.x * direction.x + direction.y * direction.y);
-            if (length > 0) {
-                direction /= length;
-                sprite.move(direction * speed * deltaTime);
-            }
-        }
-    }
-
-    sf::Vector2f getCenter() {
-        sf::FloatRect bounds = sprite.getGlobalBounds();
-        return sf::Vector2f(bounds.left + bounds.width / 2, bounds.top + bounds.height / 2);
-    }
-
-    sf::FloatRect getBounds() {
-        return sprite.getGlobalBounds();
-    }
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Decoded samples of a sound, filled on a loader thread
+struct SoundSamples {
+    std::vector<sf::Int16> samples;
+    unsigned channelCount = 0;
+    unsigned sampleRate = 0;
+    bool loaded = false;
 };
 
-// Powerup class
-class Powerup {
-public:
-    sf::Sprite sprite;
-    PowerupType type;
-    bool active;
-    float lifetime;
-
-    Powerup(float x, float y, PowerupType powerupType, sf::Texture& texture) {
-        type = powerupType;
-        active = true;
-        lifetime = 10.0f;
-
-        sprite.setTexture(texture);
-        sprite.setPosition(x, y);
-        sprite.setScale(0.1f, 0.1f); // Increased for visibility
-    }
-
-    void update(float deltaTime) {
-        lifetime -= deltaTime;
-        if (lifetime <= 0) {
-            active = false;
+// Queues a sound to be decoded on a loader thread and copied into buffer on
+// the main thread; loaded says whether that worked. The sound is read from
+// archive if it is in there, else from its loose file.
+void queueSound(AssetLoader& loader, const AssetArchive& archive, const std::string& filename, sf::SoundBuffer& buffer, bool& loaded) {
+    auto decoded = std::make_shared<SoundSamples>();
+    loader.add([decoded, filename, &archive] {
+        sf::InputSoundFile file;
+        AssetArchive::Asset archived = archive.find(filename);
+        if (archived ? !file.openFromMemory(archived.data, archived.size) : !file.openFromFile(filename)) return;
+        decoded->samples.resize(static_cast<size_t>(file.getSampleCount()));
+        decoded->channelCount = file.getChannelCount();
+        decoded->sampleRate = file.getSampleRate();
+        decoded->loaded = file.read(decoded->samples.data(), decoded->samples.size()) == decoded->samples.size();
+    }, [decoded, filename, &buffer, &loaded] {
+        loaded = decoded->loaded && buffer.loadFromSamples(decoded->samples.data(), decoded->samples.size(),
+            decoded->channelCount, decoded->sampleRate);
+        if (!loaded) {
+            LOG_WARN("Could not load %s", filename.c_str());
         }
-        float pulse = sin(lifetime * 5) * 0.02f + 1.0f;
-        sprite.setScale(0.12f * pulse, 0.12f * pulse);
-    }
-
-    sf::FloatRect getBounds() {
-        return sprite.getGlobalBounds();
-    }
-};
+        decoded->samples = std::vector<sf::Int16>();
+    });
+}
 
 // Button class
 class Button {
@@ -363,63 +98,300 @@ public:
     }
 };
 
-// Utility functions
-float distance(sf::Vector2f a, sf::Vector2f b) {
-    return sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
-}
+// Steps the simulation without a window for a fixed number of ticks and
+// reports throughput. Rounds that end are restarted so long soak runs keep
+// the world busy. With recordFile, the first round is saved as a replay.
+int runHeadless(int frames, const std::string& level, const std::string& wavesFile, sf::Vector2f arenaSize, bool separation,
+    const std::string& recordFile) {
+    std::random_device rd;
+    World world(loadHeadlessArt(), rd());
+    world.setArenaSize(arenaSize.x, arenaSize.y);
+    world.crowdSeparation = separation;
+    if (!level.empty() && !world.loadLevel(level)) {
+        std::cout << "Could not load level " << level << std::endl;
+        return 1;
+    }
+    if (!wavesFile.empty() && !world.loadWaves(wavesFile)) {
+        std::cout << "Could not load waves " << wavesFile << std::endl;
+        return 1;
+    }
+    unsigned seed = rd();
+    world.start(PLAYING_TIME_TRIAL, seed);
+
+    Replay replay;
+    bool recording = !recordFile.empty();
+    replay.begin(seed, PLAYING_TIME_TRIAL, arenaSize, level, wavesFile, separation);
+    auto saveReplay = [&] {
+        replay.finish(world);
+        recording = false;
+        if (replay.save(recordFile)) {
+            std::cout << "Recorded " << replay.inputs.size() << " ticks to " << recordFile << std::endl;
+        }
+        else {
+            std::cout << "Could not write " << recordFile << std::endl;
+        }
+    };
+
+    int rounds = 0;
+    long long totalKills = 0;
+    int peakEnemies = 0;
 
-sf::Vector2f normalize(sf::Vector2f vector) {
-    float length = sqrt(vector.x * vector.x + vector.y * vector.y);
-    if (length > 0) {
-        return sf::Vector2f(vector.x / length, vector.y / length);
+    sf::Clock clock;
+    for (int frame = 0; frame < frames; frame++) {
+        TickEvents events;
+        PlayerInput input = autopilotInput(world, frame);
+        if (recording) replay.record(input);
+        world.step(SIMULATION_STEP, input, events);
+        Profiler::instance().endFrame();
+        totalKills += events.enemiesKilled;
+        peakEnemies = std::max(peakEnemies, world.enemies.count());
+        if (!world.isPlaying()) {
+            if (recording) saveReplay();
+            rounds++;
+            world.start(PLAYING_TIME_TRIAL, rd());
+        }
     }
-    return sf::Vector2f(0, 0);
+    float seconds = clock.getElapsedTime().asSeconds();
+    if (recording) saveReplay();
+
+    std::cout << "Headless: " << frames << " ticks (" << frames * SIMULATION_STEP << " s of game time) in " << seconds << " s ("
+        << (seconds > 0 ? frames / seconds : 0.0f) << " ticks/s)\n"
+        << "Rounds finished: " << rounds << ", kills: " << totalKills
+        << ", peak enemies: " << peakEnemies << "\n"
+        << "Collision proxies: " << world.transformsEvaluated << " transforms worked out, "
+        << world.transformsSaved() << " saved\n"
+        << "Per-tick times over the last " << Profiler::instance().frameCount() << " ticks:\n"
+        << Profiler::instance().summary() << std::flush;
+    Profiler::instance().writeCsv("profile.csv");
+    return 0;
 }
 
-bool checkCollision(const sf::FloatRect& a, const sf::FloatRect& b) {
-    return a.intersects(b);
+// Plays a recorded round back without a window and checks that it ends
+// exactly as it did when recorded. Also reports per-tick times, so a
+// recording of a slow round can be profiled again and again.
+int runReplay(const std::string& filename) {
+    Replay replay;
+    if (!replay.load(filename)) {
+        std::cout << "Could not read replay " << filename << std::endl;
+        return 1;
+    }
+    World world(loadHeadlessArt(), replay.seed);
+    world.setArenaSize(replay.arenaSize.x, replay.arenaSize.y);
+    world.crowdSeparation = replay.separation;
+    if (!replay.level.empty() && !world.loadLevel(replay.level)) {
+        std::cout << "Could not load level " << replay.level << std::endl;
+        return 1;
+    }
+    if (!replay.waves.empty() && !world.loadWaves(replay.waves)) {
+        std::cout << "Could not load waves " << replay.waves << std::endl;
+        return 1;
+    }
+    world.start(replay.mode, replay.seed);
+
+    int ticks = 0;
+    sf::Clock clock;
+    for (const PlayerInput& input : replay.inputs) {
+        if (!world.isPlaying()) break;
+        TickEvents events;
+        world.step(SIMULATION_STEP, input, events);
+        Profiler::instance().endFrame();
+        ticks++;
+    }
+    float seconds = clock.getElapsedTime().asSeconds();
+
+    ReplayOutcome expected = replay.outcome;
+    ReplayOutcome actual = replayOutcome(world, ticks);
+    auto print = [](const char* label, const ReplayOutcome& outcome) {
+        std::printf("%-9s ticks %u, spawned %u, kills %u, state %d, health %d, hash %016llx\n", label, outcome.ticks,
+            outcome.enemiesSpawned, outcome.kills, outcome.state, outcome.playerHealth, static_cast<unsigned long long>(outcome.stateHash));
+    };
+    print("Recorded:", expected);
+    print("Replayed:", actual);
+    std::cout << "Replay: " << ticks << " ticks in " << seconds << " s\n"
+        << "Per-tick times over the last " << Profiler::instance().frameCount() << " ticks:\n"
+        << Profiler::instance().summary();
+    Profiler::instance().writeCsv("profile.csv");
+
+    bool matches = actual == expected;
+    std::cout << (matches ? "MATCH: the replay reproduced the round" : "MISMATCH: the replay diverged from the recording") << std::endl;
+    return matches ? 0 : 1;
+}
+
+// Packs files into an archive for the game to load instead of the loose
+// files. With --rgba, images are stored decoded.
+int runPack(const std::string& archiveName, const std::vector<std::string>& files, bool rgba) {
+    AssetArchiveWriter writer;
+    for (const std::string& file : files) {
+        std::string extension = file.substr(file.find_last_of('.') + 1);
+        bool image = extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp" || extension == "tga";
+        if (!writer.addFile(file, rgba && image)) {
+            std::cout << "Could not add " << file << std::endl;
+            return 1;
+        }
+    }
+    if (!writer.write(archiveName)) {
+        std::cout << "Could not write " << archiveName << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << writer.assetCount() << " assets into " << archiveName << std::endl;
+    return 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    bool headless = false;
+    int headlessFrames = 7200;
+    std::string level;
+    std::string wavesFile;
+    std::string recordFile;
+    sf::Vector2f arenaSize(1600, 900);
+    int separation = -1; // on in the window, off headless, unless given
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc) {
+            headlessFrames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--level" && i + 1 < argc) {
+            level = argv[++i];
+        }
+        else if (arg == "--waves" && i + 1 < argc) {
+            wavesFile = argv[++i];
+        }
+        else if (arg == "--arena" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%fx%f", &arenaSize.x, &arenaSize.y) != 2) {
+                std::cout << "Expected --arena WIDTHxHEIGHT, e.g. --arena 4800x2700" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--separation" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value != "on" && value != "off") {
+                std::cout << "Expected --separation on or --separation off" << std::endl;
+                return 1;
+            }
+            separation = value == "on" ? 1 : 0;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            if (!Logger::instance().enableTrace(argv[++i])) {
+                std::cout << "Unknown trace category in '" << argv[i] << "'. Available: render, frame, all" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            return runReplay(argv[++i]);
+        }
+        else if (arg == "--pack" && i + 1 < argc) {
+            std::string archiveName = argv[++i];
+            bool rgba = false;
+            std::vector<std::string> files;
+            for (i++; i < argc; i++) {
+                if (std::string(argv[i]) == "--rgba") rgba = true;
+                else files.push_back(argv[i]);
+            }
+            return runPack(archiveName, files, rgba);
+        }
+        else if (arg == "--bench" && i + 1 < argc) {
+            return runBenchmark(argv[++i]);
+        }
+    }
+    if (headless) {
+        return runHeadless(headlessFrames, level, wavesFile, arenaSize, separation == 1, recordFile);
+    }
+
     std::random_device rd;
-    std::mt19937 rng(rd());
+    sf::Clock startupClock;
 
     sf::RenderWindow window(sf::VideoMode(1600, 900), "Hunt the Zombies");
     window.setFramerateLimit(60);
 
     GameState currentState = MAIN_MENU;
 
+    // Assets come from assets.pak when there is one (see --pack); the font
+    // and music keep reading from its mapping, so it stays open until exit
+    AssetArchive archive;
+    if (archive.open("assets.pak")) {
+        LOG_INFO("Loading assets from assets.pak (%d assets)", archive.assetCount());
+    }
+
     sf::Font font;
-    if (!font.loadFromFile("Montserrat-Bold.ttf")) {
-        std::cout << "Warning: Could not load Montserrat-Bold.ttf, using default font" << std::endl;
+    AssetArchive::Asset archivedFont = archive.find("Montserrat-Bold.ttf");
+    if (archivedFont ? !font.loadFromMemory(archivedFont.data, archivedFont.size) : !font.loadFromFile("Montserrat-Bold.ttf")) {
+        LOG_WARN("Could not load Montserrat-Bold.ttf, using default font");
     }
 
+    // Loading screen: images and sounds are decoded on worker threads while
+    // the main thread uploads a few finished ones per frame and draws progress
     TextureManager textures;
+    sf::SoundBuffer bulletSoundBuffer, hitSoundBuffer;
+    bool bulletSoundLoaded = false, hitSoundLoaded = false;
+    {
+        AssetLoader loader;
+        textures.queue(loader, archive);
+        queueSound(loader, archive, "bullet.ogg", bulletSoundBuffer, bulletSoundLoaded);
+        queueSound(loader, archive, "hit.ogg", hitSoundBuffer, hitSoundLoaded);
+        loader.start(std::min(4, std::max(1, static_cast<int>(std::thread::hardware_concurrency()))));
+
+        sf::Text loadingText;
+        loadingText.setFont(font);
+        loadingText.setString("Loading...");
+        loadingText.setCharacterSize(36);
+        loadingText.setFillColor(sf::Color::White);
+        loadingText.setPosition((1600 - loadingText.getLocalBounds().width) / 2, 370);
+
+        sf::RectangleShape loadingBarBg(sf::Vector2f(600, 30));
+        loadingBarBg.setPosition(500, 435);
+        loadingBarBg.setFillColor(sf::Color(50, 50, 50));
+
+        sf::RectangleShape loadingBar(sf::Vector2f(0, 30));
+        loadingBar.setPosition(500, 435);
+        loadingBar.setFillColor(sf::Color::Green);
+
+        bool firstFrame = true;
+        while (!loader.done()) {
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    window.close();
+                    return 0;
+                }
+            }
+
+            loader.uploadReady(4);
+            loadingBar.setSize(sf::Vector2f(600 * loader.progress(), 30));
+
+            window.clear();
+            window.draw(loadingText);
+            window.draw(loadingBarBg);
+            window.draw(loadingBar);
+            window.display();
+
+            if (firstFrame) {
+                LOG_INFO("First frame after %d ms", startupClock.getElapsedTime().asMilliseconds());
+                firstFrame = false;
+            }
+        }
+    }
+    LOG_INFO("Assets loaded after %d ms", startupClock.getElapsedTime().asMilliseconds());
+
     sf::Sprite backgroundSprite;
     backgroundSprite.setTexture(textures.backgroundTexture);
     backgroundSprite.setScale(1600.0f / textures.backgroundTexture.getSize().x, 900.0f / textures.backgroundTexture.getSize().y);
 
-    sf::SoundBuffer bulletSoundBuffer, hitSoundBuffer;
-    sf::Sound bulletSound, hitSound;
-    bool bulletSoundLoaded = bulletSoundBuffer.loadFromFile("bullet.ogg");
-    if (!bulletSoundLoaded) {
-        std::cout << "Warning: Could not load bullet.ogg" << std::endl;
-    }
-    else {
-        bulletSound.setBuffer(bulletSoundBuffer);
-    }
-
-    bool hitSoundLoaded = hitSoundBuffer.loadFromFile("hit.ogg");
-    if (!hitSoundLoaded) {
-        std::cout << "Warning: Could not load hit.ogg" << std::endl;
-    }
-    else {
-        hitSound.setBuffer(hitSoundBuffer);
-    }
+    // Gunshots and hits share 16 voices; kills outrank shots when voices run out
+    SoundPool sounds(16);
+    sounds.setCategoryLimit(SOUND_SHOT, 6);
+    sounds.setCategoryLimit(SOUND_HIT, 10);
 
+    // Music streams from disk as it plays; opening it only reads the header
     sf::Music backgroundMusic;
-    if (!backgroundMusic.openFromFile("bgmusic.ogg")) {
-        std::cout << "Warning: Could not load bgmusic.ogg" << std::endl;
+    AssetArchive::Asset archivedMusic = archive.find("bgmusic.ogg");
+    if (archivedMusic ? !backgroundMusic.openFromMemory(archivedMusic.data, archivedMusic.size) : !backgroundMusic.openFromFile("bgmusic.ogg")) {
+        LOG_WARN("Could not load bgmusic.ogg");
     }
     else {
         backgroundMusic.setLoop(true);
@@ -440,24 +412,22 @@ int main() {
     Button timeTrialButton(600, 450, 400, 80, "TIME TRIAL", font);
     Button exitButton(600, 550, 400, 80, "EXIT", font);
 
-    Player player(800, 450, textures.playerTexture);
-    std::vector<Bullet> bullets;
-    std::vector<Enemy> enemies;
-    std::vector<Powerup> powerups;
-    enemies.reserve(50); // Reserve space to prevent reallocations
-    powerups.reserve(10);
-
-    int totalEnemiesClassic = 30;
-    int enemiesKilled = 0;
-    float enemySpawnTimer = 0;
-    float enemySpawnDelay = 1.5f;
-    float powerupSpawnTimer = 0;
-    float powerupSpawnDelay = 7.0f;
-
-    float timeTrialDuration = 60.0f;
-    float timeTrialTimer = timeTrialDuration;
-    int timeTrialKills = 0;
-    int xpEarned = 0;
+    World world(textures.art(), rd());
+    world.setArenaSize(arenaSize.x, arenaSize.y);
+    world.crowdSeparation = separation != 0;
+    if (!level.empty() && !world.loadLevel(level)) {
+        LOG_WARN("Could not load level %s, playing the open arena", level.c_str());
+    }
+    if (!wavesFile.empty() && !world.loadWaves(wavesFile)) {
+        LOG_WARN("Could not load waves %s, spawning zombies one at a time", wavesFile.c_str());
+    }
+    Player& player = world.player;
+    SpriteBatch spriteBatch;
+    spriteBatch.setSolidTexel(&textures.atlas.texture, textures.atlas.solidTexel());
+
+    // Every bullet is drawn with this one circle, moved to it in turn
+    sf::CircleShape bulletShape(BulletStore::radius);
+    bulletShape.setFillColor(sf::Color::Yellow);
 
     sf::RectangleShape healthBarBg(sf::Vector2f(300, 30));
     healthBarBg.setPosition(20, 20);
@@ -467,23 +437,23 @@ int main() {
     healthBar.setPosition(20, 20);
     healthBar.setFillColor(sf::Color::Green);
 
-    sf::Text killCounterText;
-    killCounterText.setFont(font);
-    killCounterText.setCharacterSize(28);
-    killCounterText.setFillColor(sf::Color::White);
-    killCounterText.setPosition(20, 60);
+    HudText killCounter;
+    killCounter.text.setFont(font);
+    killCounter.text.setCharacterSize(28);
+    killCounter.text.setFillColor(sf::Color::White);
+    killCounter.text.setPosition(20, 60);
 
-    sf::Text timerText;
-    timerText.setFont(font);
-    timerText.setCharacterSize(32);
-    timerText.setFillColor(sf::Color::Yellow);
-    timerText.setPosition(20, 100);
+    HudText timer;
+    timer.text.setFont(font);
+    timer.text.setCharacterSize(32);
+    timer.text.setFillColor(sf::Color::Yellow);
+    timer.text.setPosition(20, 100);
 
-    sf::Text speedBoostText;
-    speedBoostText.setFont(font);
-    speedBoostText.setCharacterSize(24);
-    speedBoostText.setFillColor(sf::Color::Cyan);
-    speedBoostText.setPosition(20, 140);
+    HudText speedBoost;
+    speedBoost.text.setFont(font);
+    speedBoost.text.setCharacterSize(24);
+    speedBoost.text.setFillColor(sf::Color::Cyan);
+    speedBoost.text.setPosition(20, 140);
 
     sf::Text gameOverText;
     gameOverText.setFont(font);
@@ -515,60 +485,91 @@ int main() {
     timeTrialResultsText.setFillColor(sf::Color::White);
     timeTrialResultsText.setPosition(400, 300);
 
+    sf::Text profilerText;
+    profilerText.setFont(font);
+    profilerText.setCharacterSize(16);
+    profilerText.setFillColor(sf::Color::White);
+    profilerText.setPosition(1230, 20);
+    sf::RectangleShape profilerBg(sf::Vector2f(350, 220));
+    profilerBg.setPosition(1220, 10);
+    profilerBg.setFillColor(sf::Color(0, 0, 0, 170));
+    bool showProfiler = false;
+    int framesSinceProfilerUpdate = 0;
+
+    // Follows the player over arenas larger than the window; the HUD is
+    // drawn with the default view on top
+    sf::View camera = window.getDefaultView();
+
     sf::Clock clock;
+    FixedTimestep timestep(SIMULATION_STEP);
+    PlayerInput input; // shots carry over until a simulation step consumes them
+
+    // Every round starts from a fresh seed; with --record the round's seed
+    // and inputs are saved when it ends, or when the window closes mid-round
+    Replay replay;
+    bool recording = false;
+    auto startRound = [&](GameState mode) {
+        unsigned seed = rd();
+        world.start(mode, seed);
+        if (!recordFile.empty()) {
+            replay.begin(seed, mode, arenaSize, world.tiles.empty() ? std::string() : level,
+                world.waves.empty() ? std::string() : wavesFile, world.crowdSeparation);
+            recording = true;
+        }
+    };
+    auto saveReplay = [&] {
+        replay.finish(world);
+        recording = false;
+        if (replay.save(recordFile)) {
+            LOG_INFO("Recorded %d ticks to %s", static_cast<int>(replay.inputs.size()), recordFile.c_str());
+        }
+        else {
+            LOG_ERROR("Could not write replay %s", recordFile.c_str());
+        }
+    };
 
     while (window.isOpen()) {
-        float deltaTime = clock.restart().asSeconds();
+        float frameTime = clock.restart().asSeconds();
         sf::Event event;
+        input.movement = sf::Vector2f(0, 0);
 
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-
-            if (currentState == MAIN_MENU) {
-                sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                if (classicModeButton.isClicked(mousePos, event)) {
-                    currentState = PLAYING_CLASSIC;
-                    player.reset(800, 450);
-                    bullets.clear();
-                    enemies.clear();
-                    powerups.clear();
-                    enemiesKilled = 0;
-                    enemySpawnTimer = 0;
-                    powerupSpawnTimer = 0;
-                }
-                else if (timeTrialButton.isClicked(mousePos, event)) {
-                    currentState = PLAYING_TIME_TRIAL;
-                    player.reset(800, 450);
-                    bullets.clear();
-                    enemies.clear();
-                    powerups.clear();
-                    timeTrialTimer = timeTrialDuration;
-                    timeTrialKills = 0;
-                    xpEarned = 0;
-                    enemySpawnTimer = 0;
-                    powerupSpawnTimer = 0;
-                }
-                else if (exitButton.isClicked(mousePos, event)) {
+        {
+            PROFILE_SCOPE(PROFILE_EVENTS);
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
                     window.close();
                 }
-            }
 
-            if (currentState == PLAYING_CLASSIC || currentState == PLAYING_TIME_TRIAL) {
-                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+                    showProfiler = !showProfiler;
+                    framesSinceProfilerUpdate = 0;
+                }
+
+                if (currentState == MAIN_MENU) {
                     sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                    sf::Vector2f playerCenter = player.getCenter();
-                    sf::Vector2f mouseWorldPos = static_cast<sf::Vector2f>(mousePos);
-                    sf::Vector2f direction = normalize(mouseWorldPos - playerCenter);
-                    bullets.push_back(Bullet(playerCenter.x, playerCenter.y, direction));
-                    if (bulletSoundLoaded) bulletSound.play();
+                    if (classicModeButton.isClicked(mousePos, event)) {
+                        currentState = PLAYING_CLASSIC;
+                        startRound(currentState);
+                    }
+                    else if (timeTrialButton.isClicked(mousePos, event)) {
+                        currentState = PLAYING_TIME_TRIAL;
+                        startRound(currentState);
+                    }
+                    else if (exitButton.isClicked(mousePos, event)) {
+                        window.close();
+                    }
+                }
+
+                if (currentState == PLAYING_CLASSIC || currentState == PLAYING_TIME_TRIAL) {
+                    if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                        input.shots++;
+                    }
                 }
-            }
 
-            if (currentState == GAME_OVER || currentState == VICTORY || currentState == TIME_TRIAL_RESULTS) {
-                if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space) {
-                    currentState = MAIN_MENU;
+                if (currentState == GAME_OVER || currentState == VICTORY || currentState == TIME_TRIAL_RESULTS) {
+                    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space) {
+                        currentState = MAIN_MENU;
+                    }
                 }
             }
         }
@@ -581,207 +582,172 @@ int main() {
         }
 
         if (currentState == PLAYING_CLASSIC || currentState == PLAYING_TIME_TRIAL) {
-            sf::Vector2f movement(0, 0);
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) movement.y -= 1;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) movement.y += 1;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) movement.x -= 1;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) movement.x += 1;
-
-            if (movement.x != 0 || movement.y != 0) {
-                movement = normalize(movement);
-            }
-
-            player.sprite.move(movement * player.speed * deltaTime);
-            player.update(deltaTime);
-
-            sf::FloatRect playerBounds = player.getBounds();
-            sf::Vector2f playerPos = player.sprite.getPosition();
-            playerPos.x = std::max(0.0f, std::min(playerPos.x, 1600.0f - playerBounds.width));
-            playerPos.y = std::max(0.0f, std::min(playerPos.y, 900.0f - playerBounds.height));
-            player.sprite.setPosition(playerPos);
+            if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) input.movement.y -= 1;
+            if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) input.movement.y += 1;
+            if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) input.movement.x -= 1;
+            if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) input.movement.x += 1;
 
             sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-            sf::Vector2f mouseWorldPos = static_cast<sf::Vector2f>(mousePos);
-            player.rotateTowards(mouseWorldPos);
-
-            for (auto& bullet : bullets) {
-                bullet.update(deltaTime);
-            }
-            bullets.erase(std::remove_if(bullets.begin(), bullets.end(),
-                [](const Bullet& b) { return !b.active; }), bullets.end());
-
-            enemySpawnTimer += deltaTime;
-            bool shouldSpawnEnemy = false;
-            if (currentState == PLAYING_CLASSIC) {
-                shouldSpawnEnemy = (enemySpawnTimer >= enemySpawnDelay && enemies.size() + enemiesKilled < totalEnemiesClassic);
+            input.aimTarget = window.mapPixelToCoords(mousePos, camera);
+
+            TickEvents events;
+            timestep.addFrameTime(frameTime);
+            while (world.isPlaying() && timestep.consumeStep()) {
+                if (recording) replay.record(input);
+                currentState = world.step(timestep.step, input, events);
+                input.shots = 0;
             }
-            else {
-                shouldSpawnEnemy = (enemySpawnTimer >= enemySpawnDelay);
+            if (recording && !world.isPlaying()) saveReplay();
+            sounds.setListener(player.proxy.center, 1200);
+            // One sound per shot; the SOUND_SHOT limit keeps rapid fire from
+            // taking every voice
+            for (int i = 0; i < events.shotsFired && bulletSoundLoaded; i++) {
+                sounds.play(bulletSoundBuffer, SOUND_SHOT, 1, player.proxy.center);
             }
-
-            if (shouldSpawnEnemy) {
-                enemySpawnTimer = 0;
-                std::uniform_int_distribution<int> edgeDist(0, 3);
-                std::uniform_real_distribution<float> posDist(0, 1600);
-                std::uniform_real_distribution<float> posYDist(0, 900);
-                float x, y;
-                switch (edgeDist(rng)) {
-                case 0: x = posDist(rng); y = 0; break; // Top
-                case 1: x = 1600; y = posYDist(rng); break; // Right
-                case 2: x = posDist(rng); y = 900; break; // Bottom
-                case 3: x = 0; y = posYDist(rng); break; // Left
-                }
-                std::uniform_int_distribution<int> typeDist(0, 99);
-                EnemyType enemyType = (typeDist(rng) < 60) ? ENEMY_TYPE_1 : ENEMY_TYPE_2;
-                sf::Texture& enemyTexture = (enemyType == ENEMY_TYPE_1) ? textures.enemy1Texture : textures.enemy2Texture;
-                enemies.emplace_back(x, y, enemyType, enemyTexture, rng);
+            for (int i = 0; i < std::min(events.enemiesKilled, static_cast<int>(TickEvents::maxKillPositions)) && hitSoundLoaded; i++) {
+                sounds.play(hitSoundBuffer, SOUND_HIT, 2, events.killPositions[i]);
             }
 
-            powerupSpawnTimer += deltaTime;
-            if (powerupSpawnTimer >= powerupSpawnDelay) {
-                powerupSpawnTimer = 0;
-                std::uniform_real_distribution<float> xDist(100, 1500);
-                std::uniform_real_distribution<float> yDist(100, 800);
-                PowerupType powerupType = (std::uniform_int_distribution<int>(0, 1)(rng) == 0) ? HEALTH_BOOST : SPEED_BOOST;
-                sf::Texture& powerupTexture = (powerupType == HEALTH_BOOST) ? textures.healthTexture : textures.speedTexture;
-                powerups.emplace_back(xDist(rng), yDist(rng), powerupType, powerupTexture);
-            }
-
-            sf::Vector2f playerCenter = player.getCenter();
-            for (auto& enemy : enemies) {
-                enemy.update(deltaTime, playerCenter);
-                if (checkCollision(enemy.getBounds(), player.getBounds()) && enemy.active) {
-                    player.takeDamage(enemy.damage);
-                    enemy.active = false;
-                }
-            }
+            {
+                PROFILE_SCOPE(PROFILE_HUD);
+                healthBar.setSize(sf::Vector2f(300 * (static_cast<float>(player.health) / player.maxHealth), 30));
 
-            for (auto& powerup : powerups) {
-                powerup.update(deltaTime);
-                if (checkCollision(powerup.getBounds(), player.getBounds()) && powerup.active) {
-                    if (powerup.type == HEALTH_BOOST && player.health < player.maxHealth) {
-                        player.heal(20);
+                if (world.state == PLAYING_TIME_TRIAL || world.state == TIME_TRIAL_RESULTS) {
+                    timer.showTenths("Time: %.1f", world.timeTrialTimer);
+                    if (world.state == TIME_TRIAL_RESULTS) {
+                        std::ostringstream resultss;
+                        resultss << "TIME'S UP!\n\nKills: " << world.timeTrialKills << "\nXP Earned: " << world.xpEarned;
+                        timeTrialResultsText.setString(resultss.str());
                     }
-                    else if (powerup.type == SPEED_BOOST) {
-                        player.applySpeedBoost();
-                    }
-                    powerup.active = false;
                 }
-            }
 
-            for (auto& bullet : bullets) {
-                for (auto& enemy : enemies) {
-                    if (bullet.active && enemy.active && checkCollision(bullet.getBounds(), enemy.getBounds())) {
-                        bullet.active = false;
-                        enemy.active = false;
-                        if (hitSoundLoaded) hitSound.play();
-                        if (currentState == PLAYING_CLASSIC) {
-                            enemiesKilled++;
-                        }
-                        else {
-                            timeTrialKills++;
-                        }
-                    }
+                if (world.state == PLAYING_CLASSIC) {
+                    killCounter.show("Kills: %d/%d", world.enemiesKilled, world.totalEnemiesClassic);
+                }
+                else {
+                    killCounter.show("Kills: %d", world.timeTrialKills);
                 }
-            }
 
-            enemies.erase(std::remove_if(enemies.begin(), enemies.end(),
-                [](const Enemy& e) { return !e.active; }), enemies.end());
-            powerups.erase(std::remove_if(powerups.begin(), powerups.end(),
-                [](const Powerup& p) { return !p.active; }), powerups.end());
-
-            healthBar.setSize(sf::Vector2f(300 * (static_cast<float>(player.health) / player.maxHealth), 30));
-
-            if (currentState == PLAYING_TIME_TRIAL) {
-                timeTrialTimer -= deltaTime;
-                std::ostringstream ss;
-                ss << "Time: " << std::fixed << std::setprecision(1) << timeTrialTimer;
-                timerText.setString(ss.str());
-                if (timeTrialTimer <= 0) {
-                    xpEarned = timeTrialKills * 10 + static_cast<int>(timeTrialDuration * 5);
-                    std::ostringstream resultss;
-                    resultss << "TIME'S UP!\n\nKills: " << timeTrialKills << "\nXP Earned: " << xpEarned;
-                    timeTrialResultsText.setString(resultss.str());
-                    currentState = TIME_TRIAL_RESULTS;
+                if (player.hasSpeedBoost) {
+                    speedBoost.showTenths("Speed Boost: %.1fs", player.speedBoostTimer);
+                }
+                else {
+                    speedBoost.hide();
                 }
             }
+        }
+        else {
+            timestep.reset();
+            input.shots = 0;
+        }
 
-            killCounterText.setString(currentState == PLAYING_CLASSIC ?
-                "Kills: " + std::to_string(enemiesKilled) + "/" + std::to_string(totalEnemiesClassic) :
-                "Kills: " + std::to_string(timeTrialKills));
-
-            speedBoostText.setString(player.hasSpeedBoost ?
-                "Speed Boost: " + (std::ostringstream() << std::fixed << std::setprecision(1) << player.speedBoostTimer << "s").str() :
-                "");
-
-            if (player.health <= 0) {
-                currentState = GAME_OVER;
-            }
-            else if (currentState == PLAYING_CLASSIC && enemiesKilled >= totalEnemiesClassic) {
-                currentState = VICTORY;
-            }
+        if (showProfiler && framesSinceProfilerUpdate-- <= 0) {
+            char voices[160];
+            std::snprintf(voices, sizeof(voices), "voices %d/%d  stolen %d  dropped %d\ntransforms saved %lld",
+                sounds.activeCount(), sounds.voiceCount(), sounds.stolen, sounds.dropped, world.transformsSaved());
+            profilerText.setString(Profiler::instance().summary() + voices);
+            framesSinceProfilerUpdate = 30;
         }
 
-        window.clear();
-        window.draw(backgroundSprite);
+        {
+            PROFILE_SCOPE(PROFILE_DRAW);
+            window.clear();
+            window.draw(backgroundSprite);
 
-        if (currentState == MAIN_MENU) {
-            window.draw(titleText);
-            classicModeButton.draw(window);
-            timeTrialButton.draw(window);
-            exitButton.draw(window);
-        }
-        else if (currentState == PLAYING_CLASSIC || currentState == PLAYING_TIME_TRIAL) {
-            int activeEnemies = 0, activePowerups = 0, activeBullets = 0;
-            window.draw(player.sprite);
-            std::cout << "Drawing player at (" << player.sprite.getPosition().x << ", " << player.sprite.getPosition().y << ")\n";
-            for (const auto& bullet : bullets) {
-                if (bullet.active) {
-                    window.draw(bullet.shape);
-                    activeBullets++;
-                }
+            if (currentState == MAIN_MENU) {
+                window.draw(titleText);
+                classicModeButton.draw(window);
+                timeTrialButton.draw(window);
+                exitButton.draw(window);
             }
-            for (const auto& enemy : enemies) {
-                if (enemy.active) {
-                    window.draw(enemy.sprite);
+            else if (currentState == PLAYING_CLASSIC || currentState == PLAYING_TIME_TRIAL) {
+                int activeEnemies = 0, activePowerups = 0, activeBullets = 0;
+                float alpha = timestep.alpha();
+                sf::Vector2f playerOffset = lerp(player.previousPosition, player.sprite.getPosition(), alpha) - player.sprite.getPosition();
+
+                // Centre the camera on the drawn player without showing past the arena edges
+                sf::Vector2f arena = world.getArenaSize();
+                sf::Vector2f viewSize = camera.getSize();
+                sf::Vector2f focus = player.proxy.center + playerOffset;
+                focus.x = std::max(viewSize.x / 2, std::min(focus.x, arena.x - viewSize.x / 2));
+                focus.y = std::max(viewSize.y / 2, std::min(focus.y, arena.y - viewSize.y / 2));
+                camera.setCenter(focus);
+                window.setView(camera);
+                sf::FloatRect viewRect(focus - viewSize / 2.0f, viewSize);
+
+                // Anything outside viewRect is skipped before it costs any
+                // vertices; enemies are found through the collision grid,
+                // widened by the little they can move between two steps
+                world.tiles.draw(window, viewRect);
+                spriteBatch.begin();
+                spriteBatch.add(player.sprite, playerOffset);
+                LOG_TRACE(LOG_RENDER, "Drawing player at (%g, %g)", player.sprite.getPosition().x, player.sprite.getPosition().y);
+                world.bullets.each<POSITION_X, POSITION_Y, PREVIOUS_X, PREVIOUS_Y, BOUNDS>(
+                    [&](float x, float y, float previousX, float previousY, const sf::FloatRect& bounds) {
+                        if (!viewRect.intersects(bounds)) return;
+                        bulletShape.setPosition(previousX + (x - previousX) * alpha, previousY + (y - previousY) * alpha);
+                        spriteBatch.add(bulletShape);
+                        activeBullets++;
+                    });
+                sf::FloatRect enemyArea(viewRect.left - 8, viewRect.top - 8, viewRect.width + 16, viewRect.height + 16);
+                world.enemyGrid.query(enemyArea, [&](int i) {
+                    if (!world.enemies.active[i] || !enemyArea.intersects(world.enemies.getBounds(i))) return;
+                    const SpriteArt& art = world.enemies.getArt(i);
+                    spriteBatch.add(art.texture, art.rect, world.enemies.getTransform(i, alpha));
                     activeEnemies++;
-                    std::cout << "Drawing enemy at (" << enemy.sprite.getPosition().x << ", " << enemy.sprite.getPosition().y << ")\n";
+                    LOG_TRACE(LOG_RENDER, "Drawing enemy at (%g, %g)", world.enemies.x[i], world.enemies.y[i]);
+                });
+                const PowerupStore& powerups = world.powerups;
+                for (int i = 0; i < powerups.count(); i++) {
+                    if (powerups.active[i] && viewRect.intersects(powerups.bounds[i])) {
+                        const SpriteArt& art = powerups.getArt(i);
+                        spriteBatch.add(art.texture, art.rect, powerups.getTransform(i));
+                        activePowerups++;
+                        LOG_TRACE(LOG_RENDER, "Drawing powerup at (%g, %g)", powerups.x[i], powerups.y[i]);
+                    }
                 }
-            }
-            for (const auto& powerup : powerups) {
-                if (powerup.active) {
-                    window.draw(powerup.sprite);
-                    activePowerups++;
-                    std::cout << "Drawing powerup at (" << powerup.sprite.getPosition().x << ", " << powerup.sprite.getPosition().y << ")\n";
+                spriteBatch.draw(window);
+                window.setView(window.getDefaultView());
+                LOG_TRACE(LOG_FRAME, "Frame: Enemies=%d, Powerups=%d, Bullets=%d, DrawCalls=%d, Vertices=%d",
+                    activeEnemies, activePowerups, activeBullets, spriteBatch.drawCalls, spriteBatch.vertexCount);
+
+                window.draw(healthBarBg);
+                window.draw(healthBar);
+                window.draw(killCounter.text);
+                if (currentState == PLAYING_TIME_TRIAL) {
+                    window.draw(timer.text);
+                }
+                if (!speedBoost.isHidden()) {
+                    window.draw(speedBoost.text);
                 }
             }
-            std::cout << "Frame: Enemies=" << activeEnemies << ", Powerups=" << activePowerups << ", Bullets=" << activeBullets << "\n";
-
-            window.draw(healthBarBg);
-            window.draw(healthBar);
-            window.draw(killCounterText);
-            if (currentState == PLAYING_TIME_TRIAL) {
-                window.draw(timerText);
+            else if (currentState == GAME_OVER) {
+                window.draw(gameOverText);
+                window.draw(restartText);
             }
-            if (!speedBoostText.getString().isEmpty()) {
-                window.draw(speedBoostText);
+            else if (currentState == VICTORY) {
+                window.draw(victoryText);
+                window.draw(restartText);
+            }
+            else if (currentState == TIME_TRIAL_RESULTS) {
+                window.draw(timeTrialResultsText);
+                window.draw(restartText);
+            }
+
+            if (showProfiler) {
+                window.draw(profilerBg);
+                window.draw(profilerText);
             }
-        }
-        else if (currentState == GAME_OVER) {
-            window.draw(gameOverText);
-            window.draw(restartText);
-        }
-        else if (currentState == VICTORY) {
-            window.draw(victoryText);
-            window.draw(restartText);
-        }
-        else if (currentState == TIME_TRIAL_RESULTS) {
-            window.draw(timeTrialResultsText);
-            window.draw(restartText);
         }
 
-        window.display();
+        {
+            PROFILE_SCOPE(PROFILE_PRESENT);
+            window.display();
+        }
+        Profiler::instance().endFrame();
     }
 
+    if (recording) saveReplay();
+    Profiler::instance().writeCsv("profile.csv");
     return 0;
 }
\ No newline at end of file